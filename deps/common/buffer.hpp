@@ -20,6 +20,7 @@
 #include <malloc.h>
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 typedef unsigned char byte;
 class buffer {
@@ -47,6 +48,15 @@ public:
         m_write_pos = 0;
     }
 
+    /* Exchanges the contents, e.g. to send a buffer without holding its lock */
+    void swap(buffer &other)
+    {
+        std::swap(m_buf, other.m_buf);
+        std::swap(m_length, other.m_length);
+        std::swap(m_write_pos, other.m_write_pos);
+        std::swap(m_read_pos, other.m_read_pos);
+    }
+
     void resize(size_t new_size)
     {
         assert(new_size < 0xffff);
@@ -0,0 +1,66 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+/* Precompiled layouts (*.iolayout) are exported by io-cct next to the json
+ * layout, which stays the format layouts are edited in. The plugin maps the
+ * file and reads the element table in place, nothing is parsed.
+ * All fields are little endian and fixed size. The header is followed by
+ * element_count elements and, if atlas_width isn't 0, the decoded atlas as
+ * atlas_width * atlas_height RGBA pixels, row after row without padding.
+ * An embedded atlas replaces the image file selected in the source */
+#define IO_LAYOUT_MAGIC "IOLY"
+#define IO_LAYOUT_VERSION 1
+#define IO_LAYOUT_EXTENSION "iolayout"
+#define IO_LAYOUT_ID_LENGTH 32 /* Including the terminator, longer ids are cut off */
+
+struct io_layout_header {
+    char magic[4];
+    uint16_t version;
+    uint16_t element_size; /* sizeof(io_layout_element) */
+    uint32_t element_count;
+    uint32_t width, height; /* Overlay size, CFG_TOTAL_WIDTH/CFG_TOTAL_HEIGHT */
+    uint32_t flags;         /* See overlay_flag */
+    uint32_t atlas_width, atlas_height;
+};
+
+/* One element, the same values as in the json layout. Values an element
+ * type doesn't use are zero, except for min_visible which is -1 */
+struct io_layout_element {
+    char id[IO_LAYOUT_ID_LENGTH];
+    int32_t type; /* See element_type */
+    int32_t code;
+    int32_t pos[2];
+    int32_t mapping[4]; /* x, y, width, height */
+    int32_t z_level;
+    int32_t side;        /* See element_side */
+    int32_t direction;   /* Trigger direction, see direction */
+    int32_t radius;      /* Stick or mouse movement radius */
+    int32_t min_visible; /* Minimum press time in ms, -1 = source setting */
+    uint8_t mouse_type;  /* See mouse_movement */
+    uint8_t trigger_mode;
+    uint8_t reserved[2];
+};
+
+#ifdef __cplusplus
+static_assert(sizeof(io_layout_header) == 32, "io_layout_header is written as is");
+static_assert(sizeof(io_layout_element) == 88, "io_layout_element is written as is");
+#endif
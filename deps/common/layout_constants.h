@@ -48,6 +48,7 @@
 #define CFG_MOUSE_TYPE "mouse_type"
 #define CFG_DIRECTION "direction"
 #define CFG_TRIGGER_MODE "trigger_mode"
+#define CFG_MIN_VISIBLE "min_visible"
 
 /* Misc */
 #define PAD_COUNT 4
@@ -5,6 +5,16 @@
  * github.com/univrsal/input-overlay
  */
 #pragma once
+#include "buffer.hpp"
+#include <stdint.h>
+
+/* Everything the client sends after its name is framed, so the server can
+ * tell where a message ends without knowing its type and can keep partial
+ * frames until the rest arrives:
+ * message id (1 byte), payload size (2 bytes, big endian), payload.
+ * Messages from the server to the client are a single message id */
+#define FRAME_HEADER_SIZE 3
+#define FRAME_MAX_PAYLOAD 1024 /* Larger frames are a protocol error */
 
 namespace network {
 enum message : char {
@@ -14,13 +24,37 @@ enum message : char {
     MSG_NAME_INVALID,
     MSG_SERVER_SHUTDOWN,
     MSG_PING_CLIENT,
-    MSG_UIOHOOK_EVENT,
+    MSG_INPUT_EVENTS, /* See wire.hpp */
     MSG_MOUSE_WHEEL_RESET,
-    MSG_GAMEPAD_EVENT,
+    MSG_WIRE_VERSION, /* WIRE_VERSION as one byte */
     MSG_GAMEPAD_CONNECTED,
     MSG_CLIENT_DC,
     MSG_REFRESH,
     MSG_END_BUFFER,
     MSG_LAST
 };
+
+/* Writes the header of a frame, returns its position for end_frame */
+inline size_t begin_frame(buffer &buf, message msg)
+{
+    const auto start = buf.write_pos();
+    const uint8_t header[FRAME_HEADER_SIZE] = {uint8_t(msg), 0, 0};
+    buf.write(header, sizeof(header));
+    return start;
+}
+
+/* Fills in the payload size of the frame started at start */
+inline void end_frame(buffer &buf, size_t start)
+{
+    const auto size = buf.write_pos() - start - FRAME_HEADER_SIZE;
+    assert(size <= FRAME_MAX_PAYLOAD);
+    buf[start + 1] = byte(size >> 8);
+    buf[start + 2] = byte(size & 0xff);
+}
+
+/* Frame without a payload */
+inline void write_frame(buffer &buf, message msg)
+{
+    end_frame(buf, begin_frame(buf, msg));
+}
 }
@@ -0,0 +1,315 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+#include "buffer.hpp"
+#include "messages.hpp"
+#include <stdint.h>
+#include <uiohook.h>
+
+/* Input events are sent in MSG_INPUT_EVENTS frames, which hold as many events
+ * as fit into FRAME_MAX_PAYLOAD. Every value is written byte by byte, so the
+ * encoding doesn't depend on the compiler's struct layout or the byte order.
+ * An event is a type tag followed by these fields:
+ * keys:    time, keycode, rawcode (typed keys: keychar)
+ * moves:   time, x, y (moved and dragged)
+ * mouse:   time, button, clicks, x, y
+ * wheel:   time, x, y, clicks, type, amount, rotation, direction
+ * gamepad: time, device index, libgamepad button/axis id, value
+ * Integers are varints (7 bits per byte, lowest first), signed ones zig-zag encoded.
+ * Times are the difference to the previous event from the same hook, x/y the
+ * difference to the previous mouse position, so a mouse move is ~4 bytes.
+ * Axis values are IEEE 754 floats, little endian.
+ * The client sends WIRE_VERSION in a MSG_WIRE_VERSION frame before any events,
+ * it has to be increased whenever the encoding changes */
+#define WIRE_VERSION 1
+#define WIRE_MAX_EVENT_SIZE 32 /* Upper bound of one encoded event */
+
+namespace network {
+/* Event tags below WIRE_PAD_BUTTON are uiohook event types */
+enum wire_tag : uint8_t { WIRE_PAD_BUTTON = 0x40, WIRE_PAD_AXIS };
+
+struct wire_pad_event {
+    bool axis;
+    uint8_t device;
+    uint16_t id; /* libgamepad button/axis id */
+    float value;
+    uint64_t time;
+};
+
+/* Previous values the deltas refer to, one per connection on each side */
+struct wire_state {
+    uint64_t time = 0;     /* uiohook */
+    uint64_t pad_time = 0; /* libgamepad */
+    int16_t x = 0, y = 0;
+};
+
+namespace wire {
+inline uint64_t zigzag(int64_t v)
+{
+    return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v)
+{
+    return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+inline void write_varint(buffer &buf, uint64_t v)
+{
+    uint8_t bytes[10];
+    size_t n = 0;
+    while (v >= 0x80) {
+        bytes[n++] = uint8_t(v | 0x80);
+        v >>= 7;
+    }
+    bytes[n++] = uint8_t(v);
+    buf.write(bytes, n);
+}
+
+inline void write_svarint(buffer &buf, int64_t v)
+{
+    write_varint(buf, zigzag(v));
+}
+
+inline void write_float(buffer &buf, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint8_t bytes[4] = {uint8_t(bits), uint8_t(bits >> 8), uint8_t(bits >> 16), uint8_t(bits >> 24)};
+    buf.write(bytes, sizeof(bytes));
+}
+
+/* Reads values from a payload. Reading past the end or values which are out
+ * of range fail and make all further reads fail too, check ok() afterwards */
+class reader {
+    const uint8_t *m_data;
+    size_t m_size, m_pos = 0;
+    bool m_ok = true;
+
+public:
+    reader(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+    bool ok() const { return m_ok; }
+    bool done() const { return !m_ok || m_pos >= m_size; }
+
+    uint64_t varint()
+    {
+        uint64_t v = 0;
+        for (unsigned shift = 0; m_ok && shift < 64; shift += 7) {
+            if (m_pos >= m_size)
+                break;
+            const auto b = m_data[m_pos++];
+            v |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+        m_ok = false;
+        return 0;
+    }
+
+    int64_t svarint() { return unzigzag(varint()); }
+
+    uint16_t u16()
+    {
+        const auto v = varint();
+        if (v > 0xffff)
+            m_ok = false;
+        return uint16_t(v);
+    }
+
+    uint8_t u8()
+    {
+        const auto v = varint();
+        if (v > 0xff)
+            m_ok = false;
+        return uint8_t(v);
+    }
+
+    float f32()
+    {
+        if (!m_ok || m_size - m_pos < 4) {
+            m_ok = false;
+            return 0.f;
+        }
+        const auto *b = m_data + m_pos;
+        const auto bits = uint32_t(b[0]) | uint32_t(b[1]) << 8 | uint32_t(b[2]) << 16 | uint32_t(b[3]) << 24;
+        m_pos += 4;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+inline void write_position(buffer &buf, wire_state &s, int16_t x, int16_t y)
+{
+    write_svarint(buf, int32_t(x) - s.x);
+    write_svarint(buf, int32_t(y) - s.y);
+    s.x = x;
+    s.y = y;
+}
+
+inline void read_position(reader &r, wire_state &s, int16_t &x, int16_t &y)
+{
+    x = s.x = int16_t(s.x + r.svarint());
+    y = s.y = int16_t(s.y + r.svarint());
+}
+
+inline void write_time(buffer &buf, uint64_t &last, uint64_t time)
+{
+    write_svarint(buf, int64_t(time - last));
+    last = time;
+}
+
+inline uint64_t read_time(reader &r, uint64_t &last)
+{
+    return last += uint64_t(r.svarint());
+}
+
+inline void write_event(buffer &buf, wire_state &s, const uiohook_event &event)
+{
+    buf.write<uint8_t>(uint8_t(event.type));
+    write_time(buf, s.time, event.time);
+
+    switch (event.type) {
+    case EVENT_KEY_PRESSED:
+    case EVENT_KEY_RELEASED:
+    case EVENT_KEY_TYPED:
+        write_varint(buf, event.data.keyboard.keycode);
+        write_varint(buf, event.data.keyboard.rawcode);
+        if (event.type == EVENT_KEY_TYPED)
+            write_varint(buf, event.data.keyboard.keychar);
+        break;
+    case EVENT_MOUSE_WHEEL:
+        write_position(buf, s, event.data.wheel.x, event.data.wheel.y);
+        write_varint(buf, event.data.wheel.clicks);
+        write_varint(buf, event.data.wheel.type);
+        write_varint(buf, event.data.wheel.amount);
+        write_svarint(buf, event.data.wheel.rotation);
+        write_varint(buf, event.data.wheel.direction);
+        break;
+    case EVENT_MOUSE_MOVED:
+    case EVENT_MOUSE_DRAGGED:
+        write_position(buf, s, event.data.mouse.x, event.data.mouse.y);
+        break;
+    default: /* All other events are mouse button events */
+        write_varint(buf, event.data.mouse.button);
+        write_varint(buf, event.data.mouse.clicks);
+        write_position(buf, s, event.data.mouse.x, event.data.mouse.y);
+    }
+}
+
+inline void write_pad_event(buffer &buf, wire_state &s, const wire_pad_event &event)
+{
+    buf.write<uint8_t>(event.axis ? WIRE_PAD_AXIS : WIRE_PAD_BUTTON);
+    write_time(buf, s.pad_time, event.time);
+    write_varint(buf, event.device);
+    write_varint(buf, event.id);
+    write_float(buf, event.value);
+}
+
+/* Reads the next event into event or pad, depending on the returned tag
+ * (a uiohook event type or a wire_tag). Returns 0 if the payload is malformed */
+inline uint8_t read_event(reader &r, wire_state &s, uiohook_event &event, wire_pad_event &pad)
+{
+    const auto tag = r.u8();
+
+    if (tag == WIRE_PAD_BUTTON || tag == WIRE_PAD_AXIS) {
+        pad.axis = tag == WIRE_PAD_AXIS;
+        pad.time = read_time(r, s.pad_time);
+        pad.device = r.u8();
+        pad.id = r.u16();
+        pad.value = r.f32();
+        return r.ok() ? tag : 0;
+    }
+
+    if (tag < EVENT_KEY_TYPED || tag > EVENT_MOUSE_WHEEL)
+        return 0;
+
+    event = {};
+    event.type = event_type(tag);
+    event.time = read_time(r, s.time);
+
+    switch (event.type) {
+    case EVENT_KEY_PRESSED:
+    case EVENT_KEY_RELEASED:
+    case EVENT_KEY_TYPED:
+        event.data.keyboard.keycode = r.u16();
+        event.data.keyboard.rawcode = r.u16();
+        event.data.keyboard.keychar = event.type == EVENT_KEY_TYPED ? r.u16() : CHAR_UNDEFINED;
+        break;
+    case EVENT_MOUSE_WHEEL:
+        read_position(r, s, event.data.wheel.x, event.data.wheel.y);
+        event.data.wheel.clicks = r.u16();
+        event.data.wheel.type = r.u8();
+        event.data.wheel.amount = r.u16();
+        event.data.wheel.rotation = int16_t(r.svarint());
+        event.data.wheel.direction = r.u8();
+        break;
+    case EVENT_MOUSE_MOVED:
+    case EVENT_MOUSE_DRAGGED:
+        read_position(r, s, event.data.mouse.x, event.data.mouse.y);
+        break;
+    default:
+        event.data.mouse.button = r.u16();
+        event.data.mouse.clicks = r.u16();
+        read_position(r, s, event.data.mouse.x, event.data.mouse.y);
+    }
+    return r.ok() ? tag : 0;
+}
+}
+
+/* Collects events into MSG_INPUT_EVENTS frames, used by the client.
+ * Consecutive events share a frame until it's full */
+class event_writer {
+    wire_state m_state;
+    size_t m_frame = 0; /* Start of the open frame in the buffer */
+    bool m_open = false;
+
+    void begin(buffer &buf)
+    {
+        if (m_open && buf.write_pos() - m_frame - FRAME_HEADER_SIZE <= FRAME_MAX_PAYLOAD - WIRE_MAX_EVENT_SIZE)
+            return;
+        finish(buf);
+        m_frame = begin_frame(buf, MSG_INPUT_EVENTS);
+        m_open = true;
+    }
+
+public:
+    void write(buffer &buf, const uiohook_event &event)
+    {
+        begin(buf);
+        wire::write_event(buf, m_state, event);
+    }
+
+    void write_pad(buffer &buf, const wire_pad_event &event)
+    {
+        begin(buf);
+        wire::write_pad_event(buf, m_state, event);
+    }
+
+    /* Closes the open frame. Has to be called before other frames are
+     * written to the buffer and before it's sent or reset */
+    void finish(buffer &buf)
+    {
+        if (m_open)
+            end_frame(buf, m_frame);
+        m_open = false;
+    }
+};
+}
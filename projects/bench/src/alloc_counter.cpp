@@ -0,0 +1,83 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "alloc_counter.hpp"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+/* Replaces the global operator new/delete to count allocations,
+ * this also catches allocations made inside Qt or the standard library */
+static std::atomic<uint64_t> allocation_count{0};
+
+static void *counted_alloc(size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto *ptr = malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size)
+{
+    return counted_alloc(size);
+}
+
+void *operator new[](size_t size)
+{
+    return counted_alloc(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+namespace bench {
+uint64_t allocations()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+}
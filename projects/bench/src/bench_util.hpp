@@ -0,0 +1,64 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdint.h>
+#include <vector>
+
+namespace bench {
+
+inline uint64_t now_ns()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/* Sorts the samples, p is in [0, 1] */
+inline uint64_t percentile(std::vector<uint64_t> &samples, double p)
+{
+    if (samples.empty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    auto idx = static_cast<size_t>(p * (samples.size() - 1));
+    return samples[idx];
+}
+
+inline void print_samples(const char *name, std::vector<uint64_t> &samples)
+{
+    printf(" %-36s n=%-8zu p50=%8llu ns  p99=%8llu ns  max=%8llu ns\n", name, samples.size(),
+           static_cast<unsigned long long>(percentile(samples, 0.5)),
+           static_cast<unsigned long long>(percentile(samples, 0.99)),
+           static_cast<unsigned long long>(percentile(samples, 1.0)));
+}
+
+/* Keeps the optimizer from dropping work whose result isn't used */
+template<class T> inline void do_not_optimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void *volatile sink;
+    sink = &value;
+#endif
+}
+
+}
@@ -0,0 +1,38 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+namespace bench {
+
+struct gamepad_options {
+    uint32_t events = 2000; /* Events written to measure the wakeup latency */
+};
+
+/* Runs the Linux gamepad monitor on fifos instead of device files:
+ * - no wakeups while there's no input
+ * - js and evdev events are decoded, init and sync events are skipped and
+ *   evdev timestamps are kept (moved to the monotonic clock)
+ * - latency from writing an event until the monitor hands it over
+ * - device files showing up are reported as hotplug
+ * Returns false if a check failed */
+bool run_gamepad_bench(const gamepad_options &opt);
+
+}
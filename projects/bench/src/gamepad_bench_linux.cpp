@@ -0,0 +1,236 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "gamepad_bench.hpp"
+#include "bench_util.hpp"
+#include <hook/gamepad_monitor.hpp>
+#include <condition_variable>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <linux/joystick.h>
+#include <mutex>
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#define GAMEPAD_BENCH_TIMEOUT_MS 1000
+#define GAMEPAD_BENCH_EVDEV_AGE_NS (5 * 1000 * 1000)       /* How old the written evdev events are */
+#define GAMEPAD_BENCH_EVDEV_TOLERANCE_NS (2 * 1000 * 1000) /* How far off their time may be after reading */
+
+namespace bench {
+
+/* Everything the monitor handed over, written on the monitor thread */
+static std::mutex mutex;
+static std::condition_variable changed;
+static std::vector<gamepad_monitor::pad_event> received;
+static uint32_t calls = 0, hotplugs = 0;
+
+static uint64_t clock_ns(const clockid_t clock)
+{
+    timespec ts{};
+    clock_gettime(clock, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+static void on_events(const gamepad_monitor::pad_event *events, const size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    received.insert(received.end(), events, events + count);
+    calls++;
+    changed.notify_all();
+}
+
+static void on_hotplug()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    hotplugs++;
+    changed.notify_all();
+}
+
+static void reset()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    received.clear();
+    calls = 0;
+    hotplugs = 0;
+}
+
+/* Waits until at least count events were received, false on timeout */
+static bool wait_events(const size_t count)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return changed.wait_for(lock, std::chrono::milliseconds(GAMEPAD_BENCH_TIMEOUT_MS),
+                            [count] { return received.size() >= count; });
+}
+
+static bool wait_hotplug()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return changed.wait_for(lock, std::chrono::milliseconds(GAMEPAD_BENCH_TIMEOUT_MS), [] { return hotplugs > 0; });
+}
+
+static bool write_js(const int fd, const uint8_t type, const uint8_t number, const int16_t value)
+{
+    js_event event{};
+    event.type = type;
+    event.number = number;
+    event.value = value;
+    return write(fd, &event, sizeof(event)) == sizeof(event);
+}
+
+static bool same(const gamepad_monitor::pad_event &event, const uint16_t code, const int32_t value, const bool axis)
+{
+    return event.code == code && event.value == value && event.axis == axis;
+}
+
+/* Opens the write end of a fifo the monitor is already reading */
+static int open_fifo(const std::string &path)
+{
+    return open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+}
+
+static bool run_js(const std::string &dir, const gamepad_options &opt)
+{
+    const auto js0 = dir + "/js0", js1 = dir + "/js1";
+    if (mkfifo(js0.c_str(), 0600) != 0 || !gamepad_monitor::start(true, on_events, on_hotplug, dir)) {
+        printf("Couldn't set up the js fifos in %s\n", dir.c_str());
+        return false;
+    }
+
+    reset();
+    const auto fd = open_fifo(js0);
+    auto ok = fd >= 0;
+
+    /* Nothing written, nothing to wake up for */
+    usleep(100 * 1000);
+    uint32_t idle_calls;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle_calls = calls;
+    }
+    ok = ok && !idle_calls;
+
+    ok = ok && write_js(fd, JS_EVENT_BUTTON | JS_EVENT_INIT, 3, 1) && write_js(fd, JS_EVENT_BUTTON, 1, 1) &&
+         write_js(fd, JS_EVENT_AXIS, 2, -32767);
+    auto decoded = ok && wait_events(2);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded = decoded && received.size() == 2 && same(received[0], 1, 1, false) &&
+                  same(received[1], 2, -32767, true);
+    }
+
+    /* One event at a time, each one has to wake the monitor on its own */
+    std::vector<uint64_t> latency;
+    latency.reserve(opt.events);
+    reset();
+    for (uint32_t i = 0; ok && i < opt.events; i++) {
+        const auto written = clock_ns(CLOCK_MONOTONIC);
+        if (!write_js(fd, JS_EVENT_BUTTON, 0, int16_t(i & 1)) || !wait_events(i + 1)) {
+            ok = false;
+            break;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        latency.emplace_back(received[i].time - written);
+    }
+
+    reset();
+    const auto hotplug = mkfifo(js1.c_str(), 0600) == 0 && wait_hotplug();
+
+    gamepad_monitor::stop();
+    if (fd >= 0)
+        close(fd);
+    unlink(js1.c_str());
+    unlink(js0.c_str());
+
+    printf(" %-36s %u\n", "js, wakeups while idle", idle_calls);
+    printf(" %-36s %s\n", "js, decoded events", decoded ? "ok" : "failed");
+    print_samples("js, write to monitor", latency);
+    printf(" %-36s %s\n", "js, hotplug", hotplug ? "ok" : "failed");
+    return ok && decoded && hotplug;
+}
+
+static input_event make_input(const uint64_t time, const uint16_t type, const uint16_t code, const int32_t value)
+{
+    input_event event{};
+    event.input_event_sec = decltype(event.input_event_sec)(time / 1000000000ull);
+    event.input_event_usec = decltype(event.input_event_usec)(time % 1000000000ull / 1000);
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    return event;
+}
+
+static bool run_evdev(const std::string &dir)
+{
+    /* Fifos don't know EVIOCSCLOCKID, so the monitor gets real time stamps like from an old kernel */
+    const auto by_id = dir + "/by-id", pad = by_id + "/io-bench-event-joystick";
+    if (mkdir(by_id.c_str(), 0700) != 0 || mkfifo(pad.c_str(), 0600) != 0 ||
+        !gamepad_monitor::start(false, on_events, on_hotplug, by_id)) {
+        printf("Couldn't set up the evdev fifo in %s\n", by_id.c_str());
+        return false;
+    }
+
+    reset();
+    const auto fd = open_fifo(pad);
+    const auto age = GAMEPAD_BENCH_EVDEV_AGE_NS;
+    const auto time = clock_ns(CLOCK_REALTIME) - age;
+    const input_event events[] = {make_input(time, EV_KEY, BTN_SOUTH, 1), make_input(time, EV_SYN, SYN_REPORT, 0),
+                                  make_input(time, EV_ABS, ABS_X, 1234), make_input(time, EV_SYN, SYN_REPORT, 0)};
+    const auto expected = clock_ns(CLOCK_MONOTONIC) - age;
+
+    auto decoded = fd >= 0 && write(fd, events, sizeof(events)) == sizeof(events) && wait_events(2);
+    int64_t offset = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded = decoded && received.size() == 2 && same(received[0], BTN_SOUTH, 1, false) &&
+                  same(received[1], ABS_X, 1234, true);
+        if (decoded)
+            offset = int64_t(received[0].time - expected);
+    }
+    const auto timed = decoded && llabs(offset) <= GAMEPAD_BENCH_EVDEV_TOLERANCE_NS;
+
+    gamepad_monitor::stop();
+    if (fd >= 0)
+        close(fd);
+    unlink(pad.c_str());
+    rmdir(by_id.c_str());
+
+    printf(" %-36s %s\n", "evdev, decoded events", decoded ? "ok" : "failed");
+    printf(" %-36s %s, %lld us off\n", "evdev, timestamps", timed ? "ok" : "failed", (long long)(offset / 1000));
+    return decoded && timed;
+}
+
+bool run_gamepad_bench(const gamepad_options &opt)
+{
+    char dir[] = "/tmp/io-bench-XXXXXX";
+    if (!mkdtemp(dir)) {
+        printf("Couldn't create a directory for the gamepad fifos\n");
+        return false;
+    }
+
+    printf("== gamepad monitor: fifos in %s\n", dir);
+    const auto js = run_js(dir, opt);
+    const auto evdev = run_evdev(dir);
+    rmdir(dir);
+    return js && evdev;
+}
+
+}
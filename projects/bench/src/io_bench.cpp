@@ -0,0 +1,168 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "gamepad_bench.hpp"
+#include "network_bench.hpp"
+#include "pipeline_bench.hpp"
+#include "snapshot_bench.hpp"
+#include "stubs/obs_stubs.hpp"
+#include <util/file_watcher.hpp>
+#include <util/load_worker.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static void print_usage()
+{
+    printf("io-bench usage: {options}\n");
+    printf(" --scenario=all      snapshot, pipeline, network, gamepad (Linux only) or all\n");
+    printf(" --seconds=5         runtime per snapshot scenario\n");
+    printf(" --mouse-hz=1000     rate of simulated mouse events\n");
+    printf(" --fps=60            rate of simulated video ticks\n");
+    printf(" --sources=8         number of simulated overlay sources\n");
+    printf(" --events=1000000    events per dispatch/parser run\n");
+    printf(" --frames=3600       simulated frames for the render run\n");
+    printf(" --events-per-frame=17\n");
+    printf(" --layout=<file>     layout used by the sources, can be repeated (default: presets)\n");
+    printf(" --recording=<file>  replay events from an *.iorec input recording\n");
+    printf(" --elements=<n>      use a generated layout with n key elements instead of the presets\n");
+    printf(" --fuzz-rounds=2000  random streams fed to the network parser\n");
+    printf(" --seed=1            seed of the network fuzzer\n");
+    printf(" --pad-events=2000   events written to the gamepad monitor\n");
+    printf(" --verbose           print plugin log messages\n");
+}
+
+static bool read_arg(const std::string &arg, const char *name, uint32_t &out)
+{
+    const auto len = strlen(name);
+    if (arg.compare(0, len, name) != 0 || arg.size() <= len || arg[len] != '=')
+        return false;
+    out = static_cast<uint32_t>(strtoul(arg.c_str() + len + 1, nullptr, 0));
+    return true;
+}
+
+static bool read_arg(const std::string &arg, const char *name, std::string &out)
+{
+    const auto len = strlen(name);
+    if (arg.compare(0, len, name) != 0 || arg.size() <= len || arg[len] != '=')
+        return false;
+    out = arg.substr(len + 1);
+    return true;
+}
+
+/* Writes a layout with n keyboard buttons spread over a few z levels, used to
+ * measure the element draw path of large layouts */
+static std::string write_layout(uint32_t n)
+{
+    const std::string path = "io-bench-layout.json";
+    auto *f = fopen(path.c_str(), "w");
+    if (!f)
+        return "";
+
+    fprintf(f, "{\"default_width\": 32, \"default_height\": 32, \"elements\": [\n");
+    for (uint32_t i = 0; i < n; i++) {
+        fprintf(f,
+                "{\"id\": \"key%u\", \"type\": 1, \"code\": %u, \"z_level\": %u, \"mapping\": [0, 0, 32, 32], "
+                "\"pos\": [%u, %u]}%s\n",
+                i, 2 + i % 80, i % 4, (i % 20) * 34, (i / 20) * 34, i + 1 < n ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+    return path;
+}
+
+int main(int argc, char **argv)
+{
+    bench::snapshot_options snapshot;
+    bench::pipeline_options pipeline;
+    bench::network_options network;
+    bench::gamepad_options gamepad;
+    std::string scenario = "all", layout;
+    uint32_t elements = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (read_arg(arg, "--sources", snapshot.sources)) {
+            pipeline.sources = snapshot.sources;
+            continue;
+        }
+
+        if (read_arg(arg, "--events", pipeline.events)) {
+            network.events = pipeline.events;
+            continue;
+        }
+
+        if (read_arg(arg, "--layout", layout)) {
+            pipeline.layouts.emplace_back(layout);
+            continue;
+        }
+
+        if (arg == "--verbose") {
+            obs_stubs::verbose = true;
+            continue;
+        }
+
+        if (read_arg(arg, "--scenario", scenario) || read_arg(arg, "--seconds", snapshot.seconds) ||
+            read_arg(arg, "--mouse-hz", snapshot.mouse_hz) || read_arg(arg, "--fps", snapshot.fps) ||
+            read_arg(arg, "--frames", pipeline.frames) || read_arg(arg, "--fuzz-rounds", network.fuzz_rounds) ||
+            read_arg(arg, "--seed", network.seed) || read_arg(arg, "--pad-events", gamepad.events) ||
+            read_arg(arg, "--events-per-frame", pipeline.events_per_frame) ||
+            read_arg(arg, "--recording", pipeline.recording) || read_arg(arg, "--elements", elements))
+            continue;
+        print_usage();
+        return 1;
+    }
+
+    if (!snapshot.seconds || !snapshot.mouse_hz || !snapshot.fps || !pipeline.events || !pipeline.frames ||
+        !pipeline.sources ||
+        (scenario != "all" && scenario != "snapshot" && scenario != "pipeline" && scenario != "network" &&
+         scenario != "gamepad")) {
+        print_usage();
+        return 1;
+    }
+
+    if (elements) {
+        layout = write_layout(elements);
+        if (layout.empty()) {
+            printf("Couldn't write generated layout\n");
+            return 1;
+        }
+        pipeline.layouts = {layout};
+    }
+
+    if (pipeline.layouts.empty()) {
+        pipeline.layouts = {IO_BENCH_PRESET_DIR "/wasd/wasd-full.json", IO_BENCH_PRESET_DIR "/mouse/mouse-arrow.json",
+                            IO_BENCH_PRESET_DIR "/gamepad/game-pad.json"};
+    }
+
+    auto result = 0;
+    if (scenario == "all" || scenario == "snapshot")
+        bench::run_snapshot_bench(snapshot);
+    if (scenario == "all" || scenario == "pipeline")
+        bench::run_pipeline_bench(pipeline);
+    if ((scenario == "all" || scenario == "network") && !bench::run_network_bench(network))
+        result = 1;
+#ifdef LINUX
+    if ((scenario == "all" || scenario == "gamepad") && !bench::run_gamepad_bench(gamepad))
+        result = 1;
+#endif
+    load_worker::stop();
+    file_watcher::stop();
+    return result;
+}
@@ -0,0 +1,292 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "network_bench.hpp"
+#include "bench_util.hpp"
+#include "pipeline_bench.hpp"
+#include <network/io_client.hpp>
+#include <messages.hpp>
+#include <memory>
+#include <random>
+#include <string.h>
+#include <wire.hpp>
+
+namespace bench {
+
+typedef std::vector<uint8_t> stream;
+
+/* Appends the frames in buf to s */
+static void append(stream &s, buffer &buf)
+{
+    s.insert(s.end(), buf.get(), buf.get() + buf.write_pos());
+    buf.reset();
+}
+
+/* What the client sends after its name */
+static stream start_stream()
+{
+    buffer buf(16);
+    const auto frame = network::begin_frame(buf, network::MSG_WIRE_VERSION);
+    buf.write<uint8_t>(WIRE_VERSION);
+    network::end_frame(buf, frame);
+    stream s;
+    append(s, buf);
+    return s;
+}
+
+/* Encodes events like the client, flushing every flush events */
+static stream encode(const std::vector<uiohook_event> &events, size_t first, size_t count, size_t flush)
+{
+    auto s = start_stream();
+    network::event_writer writer;
+    buffer buf(8192);
+    for (size_t i = 0; i < count; i++) {
+        writer.write(buf, events[(first + i) % events.size()]);
+        if ((i + 1) % flush == 0) {
+            writer.finish(buf);
+            append(s, buf);
+        }
+    }
+    writer.finish(buf);
+    append(s, buf);
+    return s;
+}
+
+static std::unique_ptr<network::io_client> make_client()
+{
+    return std::unique_ptr<network::io_client>(
+        new network::io_client(strdup("io-bench"), INVALID_CLIENT_SOCKET, 0));
+}
+
+static bool same_state(const input_data &a, const input_data &b)
+{
+    return a.keyboard == b.keyboard && a.mouse == b.mouse && a.last_mouse_movement.x == b.last_mouse_movement.x &&
+           a.last_mouse_movement.y == b.last_mouse_movement.y &&
+           a.last_wheel_event.rotation == b.last_wheel_event.rotation &&
+           a.last_wheel_event.amount == b.last_wheel_event.amount;
+}
+
+static bool same_event(const uiohook_event &a, const uiohook_event &b)
+{
+    if (a.type != b.type || a.time != b.time)
+        return false;
+
+    switch (a.type) {
+    case EVENT_KEY_PRESSED:
+    case EVENT_KEY_RELEASED:
+        return a.data.keyboard.keycode == b.data.keyboard.keycode && a.data.keyboard.rawcode == b.data.keyboard.rawcode;
+    case EVENT_KEY_TYPED:
+        return a.data.keyboard.keycode == b.data.keyboard.keycode &&
+               a.data.keyboard.rawcode == b.data.keyboard.rawcode && a.data.keyboard.keychar == b.data.keyboard.keychar;
+    case EVENT_MOUSE_WHEEL:
+        return a.data.wheel.x == b.data.wheel.x && a.data.wheel.y == b.data.wheel.y &&
+               a.data.wheel.clicks == b.data.wheel.clicks && a.data.wheel.type == b.data.wheel.type &&
+               a.data.wheel.amount == b.data.wheel.amount && a.data.wheel.rotation == b.data.wheel.rotation &&
+               a.data.wheel.direction == b.data.wheel.direction;
+    case EVENT_MOUSE_MOVED:
+    case EVENT_MOUSE_DRAGGED:
+        return a.data.mouse.x == b.data.mouse.x && a.data.mouse.y == b.data.mouse.y;
+    default:
+        return a.data.mouse.button == b.data.mouse.button && a.data.mouse.clicks == b.data.mouse.clicks &&
+               a.data.mouse.x == b.data.mouse.x && a.data.mouse.y == b.data.mouse.y;
+    }
+}
+
+static uiohook_event random_event(std::mt19937 &rng, uint64_t &time)
+{
+    std::uniform_int_distribution<uint32_t> any;
+    uiohook_event e{};
+    e.type = event_type(EVENT_KEY_TYPED + any(rng) % (EVENT_MOUSE_WHEEL - EVENT_KEY_TYPED + 1));
+    /* Mostly increasing, but the hook's clock is allowed to jump */
+    time = any(rng) % 16 ? time + any(rng) % 20 : uint64_t(any(rng)) << 20 | any(rng);
+    e.time = time;
+
+    switch (e.type) {
+    case EVENT_KEY_PRESSED:
+    case EVENT_KEY_RELEASED:
+    case EVENT_KEY_TYPED:
+        e.data.keyboard.keycode = uint16_t(any(rng));
+        e.data.keyboard.rawcode = uint16_t(any(rng));
+        e.data.keyboard.keychar = e.type == EVENT_KEY_TYPED ? uint16_t(any(rng)) : CHAR_UNDEFINED;
+        break;
+    case EVENT_MOUSE_WHEEL:
+        e.data.wheel.x = int16_t(any(rng));
+        e.data.wheel.y = int16_t(any(rng));
+        e.data.wheel.clicks = uint16_t(any(rng));
+        e.data.wheel.type = uint8_t(any(rng));
+        e.data.wheel.amount = uint16_t(any(rng));
+        e.data.wheel.rotation = int16_t(any(rng));
+        e.data.wheel.direction = uint8_t(any(rng));
+        break;
+    default:
+        e.data.mouse.button = uint16_t(any(rng));
+        e.data.mouse.clicks = uint16_t(any(rng));
+        e.data.mouse.x = int16_t(any(rng));
+        e.data.mouse.y = int16_t(any(rng));
+    }
+    return e;
+}
+
+/* Feeds s in chunks of random size, at most max_chunk bytes */
+static void feed(network::io_client &client, const stream &s, std::mt19937 &rng, size_t max_chunk)
+{
+    std::uniform_int_distribution<size_t> chunk(1, max_chunk);
+    for (size_t pos = 0; pos < s.size();) {
+        const auto length = std::min(chunk(rng), s.size() - pos);
+        client.receive(s.data() + pos, length);
+        client.publish_data();
+        pos += length;
+    }
+}
+
+static void run_throughput(const network_options &opt, const std::vector<uiohook_event> &events)
+{
+    /* The client flushes every LISTEN_TIMEOUT (25 ms), which is ~25 events at 1000 Hz */
+    const auto s = encode(events, 0, events.size(), 25);
+    const auto raw = events.size() * (1 + sizeof(uiohook_event));
+
+    printf("== network: %u events, %zu byte stream per %zu events\n", opt.events, s.size(), events.size());
+    printf(" %-36s %8.1f bytes/event raw structs, %.1f encoded (%.1fx)\n", "size", double(raw) / events.size(),
+           double(s.size()) / events.size(), double(raw) / s.size());
+
+    /* One byte reads are the worst case for partial frames, 1460 is a typical
+     * TCP segment and 64k a burst that used to overflow the receive buffer */
+    for (const size_t read_size : {size_t(1), size_t(7), size_t(1460), size_t(65536)}) {
+        auto client = make_client();
+        std::vector<uint64_t> samples;
+        uint64_t total = 0, parsed = 0;
+
+        while (parsed < opt.events) {
+            const auto start = now_ns();
+            for (size_t pos = 0; pos < s.size(); pos += read_size)
+                client->receive(s.data() + pos, std::min(read_size, s.size() - pos));
+            client->publish_data();
+            const auto time = now_ns() - start;
+            samples.emplace_back(time);
+            total += time;
+            parsed += events.size();
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "receive, %zu byte reads", read_size);
+        printf(" %-36s %12.0f events/s  %8.1f ns/event  %8.1f MiB/s\n", name, parsed * 1e9 / double(total),
+               double(total) / parsed, (parsed / double(events.size())) * s.size() / (1024 * 1024) / (total / 1e9));
+        do_not_optimize(client->read_data());
+    }
+}
+
+static bool run_fuzz(const network_options &opt, const std::vector<uiohook_event> &events)
+{
+    std::mt19937 rng(opt.seed);
+    std::uniform_int_distribution<uint32_t> any;
+    buffer buf(8192);
+    uint32_t codec_failures = 0, split_failures = 0, skip_failures = 0, garbage_invalid = 0;
+    uint64_t time = 0;
+
+    for (uint32_t round = 0; round < opt.fuzz_rounds; round++) {
+        /* Random field values have to come out of the encoding unchanged */
+        std::vector<uiohook_event> sent(1 + any(rng) % 200);
+        network::event_writer writer;
+        for (auto &e : sent) {
+            e = random_event(rng, time);
+            writer.write(buf, e);
+        }
+        writer.finish(buf);
+
+        network::wire_state state;
+        size_t received = 0;
+        for (size_t pos = 0; pos < buf.write_pos() && received <= sent.size();) {
+            const size_t size = size_t(buf[pos + 1]) << 8 | buf[pos + 2];
+            network::wire::reader reader(buf.get() + pos + FRAME_HEADER_SIZE, size);
+            uiohook_event e;
+            network::wire_pad_event pad;
+            while (!reader.done() && network::wire::read_event(reader, state, e, pad) &&
+                   received < sent.size() && same_event(sent[received], e))
+                received++;
+            pos += FRAME_HEADER_SIZE + size;
+        }
+        if (received != sent.size())
+            codec_failures++;
+        buf.reset();
+
+        /* The same events once as is and once with frames the parser has to skip */
+        const auto count = 1 + any(rng) % 200;
+        const auto first = any(rng) % events.size();
+        const auto valid = encode(events, first, count, 1 + any(rng) % 30);
+        auto noisy = start_stream();
+        network::event_writer noisy_writer;
+        for (uint32_t i = 0; i < count; i++) {
+            noisy_writer.write(buf, events[(first + i) % events.size()]);
+            if (any(rng) % 4 == 0) {
+                noisy_writer.finish(buf);
+                const auto frame =
+                    network::begin_frame(buf, network::message(network::MSG_LAST + 1 + any(rng) % 64));
+                const auto size = any(rng) % (FRAME_MAX_PAYLOAD + 1);
+                for (uint32_t j = 0; j < size; j++)
+                    buf.write<uint8_t>(uint8_t(any(rng)));
+                network::end_frame(buf, frame);
+            }
+        }
+        noisy_writer.finish(buf);
+        append(noisy, buf);
+
+        auto reference = make_client();
+        reference->receive(valid.data(), valid.size());
+        reference->publish_data();
+
+        auto split = make_client();
+        feed(*split, valid, rng, any(rng) % 2 ? 16 : 4096);
+        if (!reference->valid() || !split->valid() || !same_state(reference->read_data(), split->read_data()))
+            split_failures++;
+
+        auto skipped = make_client();
+        feed(*skipped, noisy, rng, 1 + any(rng) % 2048);
+        if (!skipped->valid() || !same_state(reference->read_data(), skipped->read_data()))
+            skip_failures++;
+
+        /* Anything goes as long as it doesn't crash or hang */
+        auto garbage = start_stream();
+        garbage.resize(garbage.size() + any(rng) % 4096);
+        for (auto i = start_stream().size(); i < garbage.size(); i++)
+            garbage[i] = uint8_t(any(rng));
+        auto random = make_client();
+        feed(*random, garbage, rng, 64);
+        if (!random->valid())
+            garbage_invalid++;
+    }
+
+    printf("== network fuzz: %u rounds, seed %u\n", opt.fuzz_rounds, opt.seed);
+    printf(" %-36s %u failed\n", "encode/decode random events", codec_failures);
+    printf(" %-36s %u failed\n", "split frames", split_failures);
+    printf(" %-36s %u failed\n", "unknown frames", skip_failures);
+    printf(" %-36s %u disconnected\n", "random bytes", garbage_invalid);
+    return !codec_failures && !split_failures && !skip_failures;
+}
+
+bool run_network_bench(const network_options &opt)
+{
+    /* 1000 Hz, like a typical gaming mouse */
+    auto events = make_events(100000);
+    for (size_t i = 0; i < events.size(); i++)
+        events[i].time = 1000000 + i;
+
+    run_throughput(opt, events);
+    return run_fuzz(opt, events);
+}
+
+}
@@ -18,31 +18,24 @@
 
 #pragma once
 
-#include "element_texture.hpp"
-#include <netlib.h>
+#include <stdint.h>
 
-enum stick_data_type {
-    SD_BOTH,
-    SD_PRESSED_STATE_LEFT,
-    SD_PRESSED_STATE_RIGHT,
-    SD_LEFT_X,
-    SD_LEFT_Y,
-    SD_RIGHT_X,
-    SD_RIGHT_Y
-};
-
-class element_analog_stick : public element_texture {
-public:
-    element_analog_stick() : element_texture(ET_ANALOG_STICK), m_side() {}
-
-    void load(const QJsonObject &obj) override;
+namespace bench {
 
-    void draw(gs_effect_t *effect, gs_image_file_t *image, sources::overlay_settings *settings) override;
-
-private:
-    void calc_position(vec2 &v);
-
-    gs_rect m_pressed{};
-    element_side m_side;
-    uint8_t m_radius = 0;
+struct network_options {
+    uint32_t events = 1000000; /* Events per parser run */
+    uint32_t fuzz_rounds = 2000; /* Streams per fuzz pass */
+    uint32_t seed = 1;
 };
+
+/* Runs the io_server frame parser without sockets:
+ * - encoded size per event and throughput of io_client::receive with
+ *   differently sized reads
+ * - fuzzing: random events have to survive the wire encoding, valid streams
+ *   split at random points have to give the same state as reading them in
+ *   one go, unknown frames are skipped and random garbage must not read out
+ *   of bounds
+ * Returns false if a fuzz check failed */
+bool run_network_bench(const network_options &opt);
+
+}
@@ -0,0 +1,219 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "pipeline_bench.hpp"
+#include "alloc_counter.hpp"
+#include "bench_util.hpp"
+#include "stubs/obs_stubs.hpp"
+#include <hook/uiohook_helper.hpp>
+#include <sources/input_source.hpp>
+#include <util/input_recording.hpp>
+#include <util/latency.hpp>
+#include <util/mapped_file.hpp>
+#include <util/overlay.hpp>
+#include <util/texture_cache.hpp>
+#include <memory>
+#include <string.h>
+#include <thread>
+
+namespace bench {
+
+std::vector<uiohook_event> make_events(uint32_t count)
+{
+    static const uint16_t keys[] = {VC_W, VC_A, VC_S, VC_D};
+    std::vector<uiohook_event> events(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        auto &e = events[i];
+        e = {};
+        if (i % 100 == 0) {
+            e.type = EVENT_MOUSE_WHEEL;
+            e.data.wheel.rotation = (i / 100) % 2 ? 1 : -1;
+            e.data.wheel.amount = 3;
+        } else if (i % 20 == 0) {
+            e.type = (i / 20) % 2 ? EVENT_KEY_RELEASED : EVENT_KEY_PRESSED;
+            e.data.keyboard.keycode = keys[(i / 40) % 4];
+        } else {
+            e.type = EVENT_MOUSE_MOVED;
+            e.data.mouse.x = static_cast<int16_t>(i % 1920);
+            e.data.mouse.y = static_cast<int16_t>((i * 7) % 1080);
+        }
+    }
+    return events;
+}
+
+static bool load_recording(const std::string &path, std::vector<uiohook_event> &events)
+{
+    mapped_file file;
+    io_record_header header{};
+    if (!file.open(path.c_str()) || file.size() < sizeof(header)) {
+        printf("Couldn't open input recording %s\n", path.c_str());
+        return false;
+    }
+
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, IO_REC_MAGIC, sizeof(header.magic)) != 0 || header.record_size != sizeof(io_record)) {
+        printf("%s is not a supported input recording\n", path.c_str());
+        return false;
+    }
+
+    const auto *records = reinterpret_cast<const io_record *>(file.data() + sizeof(header));
+    const auto count = (file.size() - sizeof(header)) / sizeof(io_record);
+    uiohook_event e;
+    for (size_t i = 0; i < count; i++) {
+        if (records[i].to_event(e))
+            events.emplace_back(e);
+    }
+    return !events.empty();
+}
+
+static void print_rate(const char *name, uint64_t events, uint64_t total_ns)
+{
+    printf(" %-36s %12.0f events/s  %8.1f ns/event\n", name, events * 1e9 / double(total_ns),
+           double(total_ns) / events);
+}
+
+static void run_dispatch(const pipeline_options &opt, const std::vector<uiohook_event> &events)
+{
+    std::vector<uint64_t> samples;
+    samples.reserve(opt.events);
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i < opt.events; i++) {
+        auto e = events[i % events.size()];
+        const auto start = now_ns();
+        uiohook::process_event(&e);
+        const auto time = now_ns() - start;
+        samples.emplace_back(time);
+        total += time;
+    }
+
+    /* Nothing drained the press queue, so most presses were dropped */
+    input_press press;
+    while (local_data::presses.pop(press)) {
+    }
+
+    printf("== dispatch: %u events\n", opt.events);
+    print_rate("process_event", opt.events, total);
+    print_samples("process_event", samples);
+}
+
+static void run_render(const pipeline_options &opt, const std::vector<uiohook_event> &events)
+{
+    std::vector<std::unique_ptr<sources::overlay_settings>> settings;
+    std::vector<std::unique_ptr<overlay>> overlays;
+
+    /* Like opening a scene collection: every source posts its load, then the
+     * video thread applies them as they finish */
+    const auto load_start = now_ns();
+    for (uint32_t i = 0; i < opt.sources; i++) {
+        settings.emplace_back(new sources::overlay_settings);
+        overlays.emplace_back(new overlay(settings.back().get()));
+        settings.back()->image_file = "bench.png";
+        settings.back()->layout_file = opt.layouts[i % opt.layouts.size()];
+        settings.back()->mouse_sens = 50;
+        overlays.back()->load_async();
+    }
+
+    for (bool loading = true; loading;) {
+        loading = false;
+        for (auto &o : overlays) {
+            o->poll_load();
+            loading |= o->is_loading();
+        }
+        if (loading)
+            std::this_thread::yield();
+    }
+    const auto load_time = now_ns() - load_start;
+
+    for (uint32_t i = 0; i < opt.sources; i++) {
+        if (!overlays[i]->is_loaded()) {
+            printf("Couldn't load layout %s\n", settings[i]->layout_file.c_str());
+            return;
+        }
+    }
+
+    std::vector<uint64_t> tick_samples, draw_samples;
+    tick_samples.reserve(opt.frames);
+    draw_samples.reserve(opt.frames);
+    uint64_t allocations = 0, draw_calls = 0, state_calls = 0;
+    size_t next_event = 0;
+
+    for (uint32_t frame = 0; frame < opt.frames; frame++) {
+        obs_stubs::frame_time += 16666667; /* 60 fps */
+        for (uint32_t i = 0; i < opt.events_per_frame; i++) {
+            auto e = events[next_event++ % events.size()];
+            uiohook::process_event(&e);
+        }
+
+        const auto allocs = bench::allocations();
+        const auto draws = obs_stubs::draw_calls;
+        const auto states = obs_stubs::state_calls;
+
+        const auto start = now_ns();
+        for (auto &o : overlays)
+            o->refresh_data();
+        const auto refreshed = now_ns();
+        for (auto &o : overlays)
+            o->draw(nullptr);
+        const auto end = now_ns();
+
+        tick_samples.emplace_back(refreshed - start);
+        draw_samples.emplace_back(end - refreshed);
+        allocations += bench::allocations() - allocs;
+        draw_calls += obs_stubs::draw_calls - draws;
+        state_calls += obs_stubs::state_calls - states;
+    }
+
+    printf("== render: %u frames, %u sources, %u events per frame\n", opt.frames, opt.sources,
+           opt.events_per_frame);
+    const auto atlases = texture_cache::stats();
+    printf(" %-36s %8.2f ms  %zu atlas(es), %zu loaded (%zu from disk cache), %zu shared, %.2f MiB\n",
+           "load: all sources", load_time / 1e6, atlases.atlases, atlases.loads, atlases.disk_hits, atlases.hits,
+           double(atlases.bytes) / (1024 * 1024));
+    print_samples("tick: refresh_data, all sources", tick_samples);
+    print_samples("render: draw, all sources", draw_samples);
+    printf(" %-36s %8.2f allocations  %8.1f draw calls  %8.1f gs state calls\n", "per frame",
+           double(allocations) / opt.frames, double(draw_calls) / opt.frames, double(state_calls) / opt.frames);
+
+    /* Only covers the time spent in the plugin, the bench doesn't wait for vsync */
+    const auto *local = latency::find(latency::input_slot(0));
+    if (local) {
+        const auto s = local->stats();
+        printf(" %-36s p50 %6llu us  p95 %6llu us  p99 %6llu us  (%llu samples)\n", "latency: hook to render",
+               (unsigned long long)s.p50, (unsigned long long)s.p95, (unsigned long long)s.p99,
+               (unsigned long long)s.samples);
+    }
+}
+
+void run_pipeline_bench(const pipeline_options &opt)
+{
+    std::vector<uiohook_event> events;
+    if (!opt.recording.empty()) {
+        if (!load_recording(opt.recording, events))
+            return;
+        printf("Using %zu events from %s\n", events.size(), opt.recording.c_str());
+    } else {
+        events = make_events(100000);
+    }
+
+    run_dispatch(opt, events);
+    run_render(opt, events);
+}
+
+}
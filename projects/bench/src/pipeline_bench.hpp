@@ -0,0 +1,46 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <uiohook.h>
+#include <vector>
+
+namespace bench {
+
+struct pipeline_options {
+    uint32_t events = 1000000;       /* Events per dispatch/parser run */
+    uint32_t frames = 3600;          /* Simulated video ticks */
+    uint32_t events_per_frame = 17;  /* Events dispatched between ticks, ~1000 Hz at 60 fps */
+    uint32_t sources = 8;            /* Overlay sources drawn per tick */
+    std::vector<std::string> layouts; /* Layouts used by the sources, presets if empty */
+    std::string recording;           /* *.iorec file used instead of synthetic events */
+};
+
+/* Runs the plugin's hot path against the libobs stubs:
+ * - uiohook event dispatch (dispatch + publish + press queue)
+ * - per frame refresh_data() and element draw() for a number of sources
+ * and reports events/s, ns/event, p50/p99 tick time and allocations per frame */
+void run_pipeline_bench(const pipeline_options &opt);
+
+/* Mostly mouse moves, with WASD presses/releases and the occasional scroll */
+std::vector<uiohook_event> make_events(uint32_t count);
+
+}
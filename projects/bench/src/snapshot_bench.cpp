@@ -0,0 +1,161 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "snapshot_bench.hpp"
+#include "bench_util.hpp"
+#include <util/input_data.hpp>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace bench {
+
+/* Input state as it was kept before the dense table, used as the baseline */
+struct legacy_input_data {
+    std::map<uint16_t, bool> keyboard{};
+    std::map<uint16_t, bool> mouse{};
+    std::map<uint16_t, float> gamepad_axis{};
+    std::map<uint16_t, bool> gamepad_buttons{};
+    keyboard_event_data last_key_pressed{}, last_key_released{};
+    mouse_event_data last_mouse_pressed{}, last_mouse_released{}, last_mouse_movement{};
+
+    void dispatch(const uiohook_event *event)
+    {
+        switch (event->type) {
+        case EVENT_KEY_PRESSED:
+            last_key_pressed = event->data.keyboard;
+            keyboard[event->data.keyboard.keycode] = true;
+            break;
+        case EVENT_KEY_RELEASED:
+            last_key_released = event->data.keyboard;
+            keyboard[event->data.keyboard.keycode] = false;
+            break;
+        case EVENT_MOUSE_MOVED:
+            last_mouse_movement = event->data.mouse;
+        default:;
+        }
+    }
+};
+
+/* Every 50th event is a key press/release, the rest are mouse moves */
+static void make_event(uiohook_event &e, uint32_t i)
+{
+    e = {};
+    if (i % 50 == 0) {
+        e.type = (i / 50) % 2 ? EVENT_KEY_RELEASED : EVENT_KEY_PRESSED;
+        e.data.keyboard.keycode = VC_A;
+    } else {
+        e.type = EVENT_MOUSE_MOVED;
+        e.data.mouse.x = static_cast<int16_t>(i % 1920);
+        e.data.mouse.y = static_cast<int16_t>(i % 1080);
+    }
+}
+
+template<class Writer, class Reader>
+static void run_scenario(const char *name, const snapshot_options &opt, Writer writer, Reader reader)
+{
+    std::atomic<bool> running{true};
+    std::vector<uint64_t> hook_samples, tick_samples;
+    hook_samples.reserve(opt.seconds * opt.mouse_hz + 16);
+    tick_samples.reserve(opt.seconds * opt.fps + 16);
+
+    std::thread hook_thread([&] {
+        const auto interval = 1000000000ull / opt.mouse_hz;
+        auto next = now_ns();
+        uiohook_event e;
+        uint32_t i = 0;
+        while (running) {
+            make_event(e, i++);
+            const auto start = now_ns();
+            writer(&e);
+            hook_samples.emplace_back(now_ns() - start);
+            next += interval;
+            while (now_ns() < next) /* Spin, sleeping isn't accurate enough for 1ms */
+                std::this_thread::yield();
+        }
+    });
+
+    const auto interval = 1000000000ull / opt.fps;
+    const auto end = now_ns() + opt.seconds * 1000000000ull;
+    auto next = now_ns();
+    while (now_ns() < end) {
+        const auto start = now_ns();
+        for (uint32_t s = 0; s < opt.sources; s++)
+            reader(s);
+        tick_samples.emplace_back(now_ns() - start);
+        next += interval;
+        while (now_ns() < next)
+            std::this_thread::yield();
+    }
+    running = false;
+    hook_thread.join();
+
+    printf("%s\n", name);
+    print_samples("hook: dispatch + publish", hook_samples);
+    print_samples("tick: refresh all sources", tick_samples);
+}
+
+void run_snapshot_bench(const snapshot_options &opt)
+{
+    printf("== snapshot: %u Hz mouse, %u fps, %u sources, %us per scenario\n", opt.mouse_hz, opt.fps, opt.sources,
+           opt.seconds);
+
+    {
+        /* Before: one mutex guards the state, every source deep copies it */
+        std::mutex mutex;
+        legacy_input_data data;
+        std::vector<legacy_input_data> copies(opt.sources);
+
+        /* Layouts with ~100 keys end up with an entry for each of them */
+        for (uint16_t key = 1; key <= 104; key++)
+            data.keyboard[key] = false;
+
+        run_scenario(
+            "mutex + deep copy", opt,
+            [&](const uiohook_event *e) {
+                std::lock_guard<std::mutex> lock(mutex);
+                data.dispatch(e);
+            },
+            [&](uint32_t s) {
+                std::lock_guard<std::mutex> lock(mutex);
+                copies[s] = data;
+                do_not_optimize(copies[s]);
+            });
+    }
+
+    {
+        /* After: hook thread publishes, sources copy the flat snapshot */
+        input_data data;
+        triple_buffer<input_data> snapshot;
+        std::vector<input_data> copies(opt.sources);
+
+        run_scenario(
+            "triple buffer", opt,
+            [&](const uiohook_event *e) {
+                data.dispatch_uiohook_event(e);
+                snapshot.publish(data);
+            },
+            [&](uint32_t s) {
+                copies[s].copy(&snapshot.read());
+                do_not_optimize(copies[s]);
+            });
+    }
+}
+
+}
@@ -18,28 +18,21 @@
 
 #pragma once
 
-#include "element_texture.hpp"
+#include <stdint.h>
 
-class element_dpad : public element_texture {
-public:
-    element_dpad();
+namespace bench {
 
-    void load(const QJsonObject &obj) override;
-
-    void draw(gs_effect_t *effect, gs_image_file_t *image, sources::overlay_settings *settings) override;
+struct snapshot_options {
+    uint32_t seconds = 5;    /* Runtime per scenario */
+    uint32_t mouse_hz = 1000; /* Rate of simulated mouse move events */
+    uint32_t fps = 60;       /* Rate of simulated video ticks */
+    uint32_t sources = 8;    /* Overlay sources refreshed per tick */
+};
 
-    enum {
-        TEXTURE_LEFT,
-        TEXTURE_RIGHT,
-        TEXTURE_UP,
-        TEXTURE_DOWN,
-        TEXTURE_TOP_LEFT,
-        TEXTURE_TOP_RIGHT,
-        TEXTURE_BOTTOM_LEFT,
-        TEXTURE_BOTTOM_RIGHT
-    };
+/* Simulates a high polling rate mouse on the hook thread while the video
+ * thread refreshes a number of sources. Compares the old scheme (mutex held
+ * for dispatch and for a deep copy of std::map based state) with the
+ * triple buffered snapshots and reports hook-side and tick-side latencies */
+void run_snapshot_bench(const snapshot_options &opt);
 
-private:
-    /* Center is in m_mapping */
-    gs_rect m_mappings[8]; /* Left, Right, Up, Down, Top Left, Top Right, Bottom Left, Bottom Right */
-};
+}
@@ -0,0 +1,123 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../util/bmem.h"
+#include "vec3.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct gs_effect gs_effect_t;
+typedef struct gs_effect_param gs_eparam_t;
+typedef struct gs_texture gs_texture_t;
+typedef struct gs_vertex_buffer gs_vertbuffer_t;
+typedef struct gs_index_buffer gs_indexbuffer_t;
+typedef struct gs_texture_render gs_texrender_t;
+struct vec4;
+
+#define GS_CLEAR_COLOR (1 << 0)
+
+enum gs_color_format { GS_UNKNOWN, GS_A8, GS_R8, GS_RGBA, GS_BGRX, GS_BGRA };
+enum gs_zstencil_format { GS_ZS_NONE };
+enum gs_blend_type {
+    GS_BLEND_ZERO,
+    GS_BLEND_ONE,
+    GS_BLEND_SRCCOLOR,
+    GS_BLEND_INVSRCCOLOR,
+    GS_BLEND_SRCALPHA,
+    GS_BLEND_INVSRCALPHA,
+};
+
+#define GS_DYNAMIC (1 << 1)
+
+enum gs_draw_mode { GS_POINTS, GS_LINES, GS_LINESTRIP, GS_TRIS, GS_TRISTRIP };
+
+struct gs_tvertarray {
+    size_t width;
+    void *array;
+};
+
+struct gs_vb_data {
+    size_t num;
+    struct vec3 *points;
+    struct vec3 *normals;
+    struct vec3 *tangents;
+    uint32_t *colors;
+    size_t num_tex;
+    struct gs_tvertarray *tvarray;
+};
+
+static inline struct gs_vb_data *gs_vbdata_create(void)
+{
+    return (struct gs_vb_data *)bzalloc(sizeof(struct gs_vb_data));
+}
+
+void gs_vbdata_destroy(struct gs_vb_data *data);
+
+struct gs_rect {
+    int x;
+    int y;
+    int cx;
+    int cy;
+};
+
+void gs_matrix_push(void);
+void gs_matrix_pop(void);
+void gs_matrix_translate3f(float x, float y, float z);
+void gs_matrix_rotaa4f(float x, float y, float z, float angle);
+
+gs_eparam_t *gs_effect_get_param_by_name(const gs_effect_t *effect, const char *name);
+void gs_effect_set_texture(gs_eparam_t *param, gs_texture_t *val);
+
+gs_vertbuffer_t *gs_vertexbuffer_create(struct gs_vb_data *data, uint32_t flags);
+void gs_vertexbuffer_destroy(gs_vertbuffer_t *vertbuffer);
+void gs_vertexbuffer_flush(gs_vertbuffer_t *vertbuffer);
+struct gs_vb_data *gs_vertexbuffer_get_data(const gs_vertbuffer_t *vertbuffer);
+void gs_load_vertexbuffer(gs_vertbuffer_t *vertbuffer);
+void gs_load_indexbuffer(gs_indexbuffer_t *indexbuffer);
+void gs_draw(enum gs_draw_mode draw_mode, uint32_t start_vert, uint32_t num_verts);
+
+gs_texrender_t *gs_texrender_create(enum gs_color_format format, enum gs_zstencil_format zsformat);
+void gs_texrender_destroy(gs_texrender_t *texrender);
+bool gs_texrender_begin(gs_texrender_t *texrender, uint32_t cx, uint32_t cy);
+void gs_texrender_end(gs_texrender_t *texrender);
+void gs_texrender_reset(gs_texrender_t *texrender);
+gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *texrender);
+
+void gs_clear(uint32_t clear_flags, const struct vec4 *color, float depth, uint8_t stencil);
+void gs_ortho(float left, float right, float top, float bottom, float znear, float zfar);
+void gs_blend_state_push(void);
+void gs_blend_state_pop(void);
+void gs_blend_function(enum gs_blend_type src, enum gs_blend_type dest);
+void gs_blend_function_separate(enum gs_blend_type src_c, enum gs_blend_type dest_c, enum gs_blend_type src_a,
+                                enum gs_blend_type dest_a);
+
+uint32_t gs_texture_get_width(const gs_texture_t *tex);
+uint32_t gs_texture_get_height(const gs_texture_t *tex);
+
+void gs_draw_sprite(gs_texture_t *tex, uint32_t flip, uint32_t width, uint32_t height);
+void gs_draw_sprite_subregion(gs_texture_t *tex, uint32_t flip, uint32_t x, uint32_t y, uint32_t cx, uint32_t cy);
+
+#ifdef __cplusplus
+}
+#endif
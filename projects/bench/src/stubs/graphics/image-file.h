@@ -0,0 +1,46 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include "graphics.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct gs_image_file {
+    gs_texture_t *texture;
+    enum gs_color_format format;
+    uint32_t cx;
+    uint32_t cy;
+    bool loaded;
+    uint8_t *texture_data;
+};
+
+typedef struct gs_image_file gs_image_file_t;
+
+/* Never touches the file, every image is reported as a loaded 1024x1024 texture */
+void gs_image_file_init(gs_image_file_t *image, const char *file);
+void gs_image_file_free(gs_image_file_t *image);
+void gs_image_file_init_texture(gs_image_file_t *image);
+
+#ifdef __cplusplus
+}
+#endif
@@ -18,21 +18,13 @@
 
 #pragma once
 
-#include "element_texture.hpp"
+/* The real header pulls in math.h and M_PI through math-defs.h */
+#include <math.h>
 
-#define WHEEL_MAP_MIDDLE 0
-#define WHEEL_MAP_UP 1
-#define WHEEL_MAP_DOWN 2
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
 
-class element_wheel : public element_texture {
-public:
-    element_wheel();
-
-    void load(const QJsonObject &obj) override;
-
-    void draw(gs_effect_t *effect, gs_image_file_t *image, sources::overlay_settings *settings) override;
-
-private:
-    /* Middle, Up, Down */
-    gs_rect m_mappings[3];
+struct vec2 {
+    float x, y;
 };
@@ -18,17 +18,14 @@
 
 #pragma once
 
-#include "element_texture.hpp"
-#include <layout_constants.h>
-
-class element_button : public element_texture {
-public:
-    element_button() : element_texture(ET_BUTTON), m_pressed() {}
-
-    void load(const QJsonObject &objc) override;
-
-    void draw(gs_effect_t *effect, gs_image_file_t *image, sources::overlay_settings *settings) override;
-
-private:
-    gs_rect m_pressed;
+struct vec3 {
+    float x, y, z, w;
 };
+
+static inline void vec3_set(struct vec3 *dst, float x, float y, float z)
+{
+    dst->x = x;
+    dst->y = y;
+    dst->z = z;
+    dst->w = 0.0f;
+}
@@ -18,21 +18,11 @@
 
 #pragma once
 
-#include "element_texture.hpp"
-#include <netlib.h>
-
-class element_trigger : public element_texture {
-public:
-    element_trigger();
-
-    void load(const QJsonObject &obj) override;
-
-    void draw(gs_effect_t *effect, gs_image_file_t *image, sources::overlay_settings *settings) override;
-
-private:
-    void calculate_mapping(gs_rect *pressed, vec2 *pos, float progress) const;
-    gs_rect m_pressed;
-    element_side m_side;
-    direction m_direction;
-    bool m_button_mode = false;
+struct vec4 {
+    float x, y, z, w;
 };
+
+static inline void vec4_zero(struct vec4 *v)
+{
+    v->x = v->y = v->z = v->w = 0.0f;
+}
@@ -0,0 +1,63 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+/* Minimal stand-in for the libobs headers, only declares what the plugin
+ * code linked into io-bench uses. Implemented in obs_stubs.cpp */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "graphics/graphics.h"
+#include "util/bmem.h"
+
+#define LOG_ERROR 100
+#define LOG_WARNING 200
+#define LOG_INFO 300
+#define LOG_DEBUG 400
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct obs_data obs_data_t;
+typedef struct obs_source obs_source_t;
+typedef struct obs_properties obs_properties_t;
+typedef struct obs_property obs_property_t;
+
+void blog(int log_level, const char *format, ...);
+void blogva(int log_level, const char *format, va_list args);
+
+const char *obs_module_text(const char *lookup_string);
+uint64_t obs_get_video_frame_time(void);
+void obs_enter_graphics(void);
+void obs_leave_graphics(void);
+
+const char *obs_data_get_string(obs_data_t *data, const char *name);
+long long obs_data_get_int(obs_data_t *data, const char *name);
+bool obs_data_get_bool(obs_data_t *data, const char *name);
+void obs_source_update(obs_source_t *source, obs_data_t *settings);
+
+obs_property_t *obs_properties_get(obs_properties_t *props, const char *property);
+void obs_property_list_clear(obs_property_t *p);
+size_t obs_property_list_add_int(obs_property_t *p, const char *name, long long val);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,345 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "obs_stubs.hpp"
+#include <obs-frontend-api.h>
+#include <obs-module.h>
+#include <graphics/image-file.h>
+#include <util/platform.h>
+#include <chrono>
+#include <stdlib.h>
+#include <thread>
+
+namespace obs_stubs {
+uint64_t frame_time = 0;
+uint64_t draw_calls = 0;
+uint64_t state_calls = 0;
+bool verbose = false;
+}
+
+/* Any non null pointer works, the stubs never dereference these */
+static char dummy_object;
+
+extern "C" {
+void blogva(int log_level, const char *format, va_list args)
+{
+    if (log_level > LOG_WARNING && !obs_stubs::verbose)
+        return;
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+}
+
+void blog(int log_level, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    blogva(log_level, format, args);
+    va_end(args);
+}
+
+void *bmalloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *bzalloc(size_t size)
+{
+    return calloc(1, size);
+}
+
+void bfree(void *ptr)
+{
+    free(ptr);
+}
+
+const char *obs_module_text(const char *lookup_string)
+{
+    return lookup_string;
+}
+
+uint64_t obs_get_video_frame_time(void)
+{
+    return obs_stubs::frame_time;
+}
+
+void obs_enter_graphics(void) {}
+
+void obs_leave_graphics(void) {}
+
+const char *obs_data_get_string(obs_data_t *, const char *)
+{
+    return "";
+}
+
+long long obs_data_get_int(obs_data_t *, const char *)
+{
+    return 0;
+}
+
+bool obs_data_get_bool(obs_data_t *, const char *)
+{
+    return false;
+}
+
+void obs_source_update(obs_source_t *, obs_data_t *) {}
+
+obs_property_t *obs_properties_get(obs_properties_t *, const char *)
+{
+    return nullptr;
+}
+
+void obs_property_list_clear(obs_property_t *) {}
+
+size_t obs_property_list_add_int(obs_property_t *, const char *, long long)
+{
+    return 0;
+}
+
+void gs_matrix_push(void)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_matrix_pop(void)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_matrix_translate3f(float, float, float)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_matrix_rotaa4f(float, float, float, float)
+{
+    obs_stubs::state_calls++;
+}
+
+gs_eparam_t *gs_effect_get_param_by_name(const gs_effect_t *, const char *)
+{
+    obs_stubs::state_calls++;
+    return reinterpret_cast<gs_eparam_t *>(&dummy_object);
+}
+
+void gs_effect_set_texture(gs_eparam_t *, gs_texture_t *)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_draw_sprite(gs_texture_t *, uint32_t, uint32_t, uint32_t)
+{
+    obs_stubs::draw_calls++;
+}
+
+void gs_draw_sprite_subregion(gs_texture_t *, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t)
+{
+    obs_stubs::draw_calls++;
+}
+
+/* Vertex buffers only hold on to their data, nothing is uploaded */
+void gs_vbdata_destroy(gs_vb_data *data)
+{
+    if (!data)
+        return;
+    for (size_t i = 0; i < data->num_tex; i++)
+        bfree(data->tvarray[i].array);
+    bfree(data->tvarray);
+    bfree(data->points);
+    bfree(data->normals);
+    bfree(data->tangents);
+    bfree(data->colors);
+    bfree(data);
+}
+
+gs_vertbuffer_t *gs_vertexbuffer_create(gs_vb_data *data, uint32_t)
+{
+    return reinterpret_cast<gs_vertbuffer_t *>(data);
+}
+
+void gs_vertexbuffer_destroy(gs_vertbuffer_t *vertbuffer)
+{
+    gs_vbdata_destroy(reinterpret_cast<gs_vb_data *>(vertbuffer));
+}
+
+void gs_vertexbuffer_flush(gs_vertbuffer_t *)
+{
+    obs_stubs::state_calls++;
+}
+
+gs_vb_data *gs_vertexbuffer_get_data(const gs_vertbuffer_t *vertbuffer)
+{
+    return reinterpret_cast<gs_vb_data *>(const_cast<gs_vertbuffer_t *>(vertbuffer));
+}
+
+void gs_load_vertexbuffer(gs_vertbuffer_t *)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_load_indexbuffer(gs_indexbuffer_t *)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_draw(gs_draw_mode, uint32_t, uint32_t)
+{
+    obs_stubs::draw_calls++;
+}
+
+gs_texrender_t *gs_texrender_create(gs_color_format, gs_zstencil_format)
+{
+    return reinterpret_cast<gs_texrender_t *>(&dummy_object);
+}
+
+void gs_texrender_destroy(gs_texrender_t *) {}
+
+bool gs_texrender_begin(gs_texrender_t *, uint32_t cx, uint32_t cy)
+{
+    obs_stubs::state_calls++;
+    return cx && cy;
+}
+
+void gs_texrender_end(gs_texrender_t *)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_texrender_reset(gs_texrender_t *) {}
+
+gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *)
+{
+    return reinterpret_cast<gs_texture_t *>(&dummy_object);
+}
+
+void gs_clear(uint32_t, const vec4 *, float, uint8_t)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_ortho(float, float, float, float, float, float)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_blend_state_push(void)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_blend_state_pop(void)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_blend_function(gs_blend_type, gs_blend_type)
+{
+    obs_stubs::state_calls++;
+}
+
+void gs_blend_function_separate(gs_blend_type, gs_blend_type, gs_blend_type, gs_blend_type)
+{
+    obs_stubs::state_calls++;
+}
+
+uint32_t gs_texture_get_width(const gs_texture_t *)
+{
+    return 1024;
+}
+
+uint32_t gs_texture_get_height(const gs_texture_t *)
+{
+    return 1024;
+}
+
+void gs_image_file_init(gs_image_file_t *image, const char *)
+{
+    image->texture = nullptr;
+    image->texture_data = nullptr;
+    image->format = GS_RGBA;
+    image->cx = 1024;
+    image->cy = 1024;
+    image->loaded = true;
+}
+
+void gs_image_file_free(gs_image_file_t *image)
+{
+    if (image) {
+        bfree(image->texture_data);
+        image->texture_data = nullptr;
+        image->texture = nullptr;
+    }
+}
+
+void gs_image_file_init_texture(gs_image_file_t *image)
+{
+    image->texture = reinterpret_cast<gs_texture_t *>(&dummy_object);
+    bfree(image->texture_data);
+    image->texture_data = nullptr;
+}
+
+uint64_t os_gettime_ns(void)
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void os_sleep_ms(uint32_t duration)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+}
+
+FILE *os_fopen(const char *path, const char *mode)
+{
+    return fopen(path, mode);
+}
+
+void config_set_default_string(config_t *, const char *, const char *, const char *) {}
+void config_set_default_int(config_t *, const char *, const char *, int64_t) {}
+void config_set_default_uint(config_t *, const char *, const char *, uint64_t) {}
+void config_set_default_bool(config_t *, const char *, const char *, bool) {}
+
+const char *config_get_string(config_t *, const char *, const char *)
+{
+    return nullptr;
+}
+
+int64_t config_get_int(config_t *, const char *, const char *)
+{
+    return 0;
+}
+
+uint64_t config_get_uint(config_t *, const char *, const char *)
+{
+    return 0;
+}
+
+bool config_get_bool(config_t *, const char *, const char *)
+{
+    return false;
+}
+
+void config_set_string(config_t *, const char *, const char *, const char *) {}
+void config_set_int(config_t *, const char *, const char *, int64_t) {}
+void config_set_uint(config_t *, const char *, const char *, uint64_t) {}
+void config_set_bool(config_t *, const char *, const char *, bool) {}
+
+config_t *obs_frontend_get_global_config(void)
+{
+    return nullptr;
+}
+}
@@ -0,0 +1,29 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+/* Knobs and counters of the libobs stand-in */
+namespace obs_stubs {
+extern uint64_t frame_time;  /* Returned by obs_get_video_frame_time() */
+extern uint64_t draw_calls;  /* Number of gs_draw* calls */
+extern uint64_t state_calls; /* Number of other gs_* calls (matrix, effect params, buffers) */
+extern bool verbose;         /* Print info/debug log messages too */
+}
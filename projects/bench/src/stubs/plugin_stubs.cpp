@@ -0,0 +1,33 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/* Plugin parts io-bench doesn't link (the platform specific hook and
+ * window helpers), which would otherwise need uiohook and X11 */
+
+#include <stdint.h>
+#include <string>
+
+namespace uiohook {
+uint64_t last_scroll_time = 0;
+bool state = false;
+}
+
+void GetCurrentWindowTitle(std::string &title)
+{
+    title.clear();
+}
@@ -18,21 +18,27 @@
 
 #pragma once
 
-#include "element_texture.hpp"
+#include <stddef.h>
+#include <string.h>
 
-#define ID_PRESSED 3
+#define UNUSED_PARAMETER(param) (void)param
 
-class element_gamepad_id : public element_texture {
-public:
-    element_gamepad_id();
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-    void load(const QJsonObject &obj) override;
+void *bmalloc(size_t size);
+void *bzalloc(size_t size);
+void bfree(void *ptr);
 
-    void draw(gs_effect_t *effect, gs_image_file_t *image, sources::overlay_settings *settings) override;
+static inline void *bmemdup(const void *ptr, size_t size)
+{
+    void *out = bmalloc(size);
+    if (size)
+        memcpy(out, ptr, size);
+    return out;
+}
 
-private:
-    /* 0 - 2 Player 2 - 4 (Player 1 is default)
-     * 3     Middle pressed down
-     */
-    gs_rect m_mappings[4];
-};
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Every value reads as its default (0/false/null), nothing is stored */
+typedef struct config_data config_t;
+
+void config_set_default_string(config_t *config, const char *section, const char *name, const char *value);
+void config_set_default_int(config_t *config, const char *section, const char *name, int64_t value);
+void config_set_default_uint(config_t *config, const char *section, const char *name, uint64_t value);
+void config_set_default_bool(config_t *config, const char *section, const char *name, bool value);
+
+const char *config_get_string(config_t *config, const char *section, const char *name);
+int64_t config_get_int(config_t *config, const char *section, const char *name);
+uint64_t config_get_uint(config_t *config, const char *section, const char *name);
+bool config_get_bool(config_t *config, const char *section, const char *name);
+
+void config_set_string(config_t *config, const char *section, const char *name, const char *value);
+void config_set_int(config_t *config, const char *section, const char *name, int64_t value);
+void config_set_uint(config_t *config, const char *section, const char *name, uint64_t value);
+void config_set_bool(config_t *config, const char *section, const char *name, bool value);
+
+#ifdef __cplusplus
+}
+#endif
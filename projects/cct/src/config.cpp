@@ -24,8 +24,11 @@
 #include "util/palette.hpp"
 #include "util/sdl_helper.hpp"
 #include "util/texture.hpp"
+#include <SDL_image.h>
+#include <iolayout.h>
 #include <iomanip>
 #include <fstream>
+#include <string.h>
 
 config::config(const char *texture_path, const char *config, const SDL_Point def_dim, const SDL_Point space,
                sdl_helper *h, dialog_element_settings *s)
@@ -225,6 +228,79 @@ void config::handle_events(SDL_Event *e)
         element->handle_event(e, m_helper);
 }
 
+/* Same as the plugin reads the json layout, see render_program::add */
+static io_layout_element to_binary(const json &j)
+{
+    io_layout_element e{};
+    strncpy(e.id, j[CFG_ID].string_value().c_str(), IO_LAYOUT_ID_LENGTH - 1);
+    e.type = j[CFG_TYPE].int_value();
+    e.code = j[CFG_KEY_CODE].int_value();
+    e.pos[0] = j[CFG_POS][0].int_value();
+    e.pos[1] = j[CFG_POS][1].int_value();
+    for (int i = 0; i < 4; i++)
+        e.mapping[i] = j[CFG_MAPPING][i].int_value();
+    e.z_level = j[CFG_Z_LEVEL].int_value();
+    e.side = j[CFG_SIDE].int_value();
+    e.direction = j[CFG_DIRECTION].int_value();
+    e.radius = j[e.type == ET_MOUSE_STATS ? CFG_MOUSE_RADIUS : CFG_STICK_RADIUS].int_value();
+    e.min_visible = j[CFG_MIN_VISIBLE].is_number() ? j[CFG_MIN_VISIBLE].int_value() : -1;
+    e.mouse_type = j[CFG_MOUSE_TYPE].bool_value();
+    e.trigger_mode = j[CFG_TRIGGER_MODE].bool_value();
+    return e;
+}
+
+bool config::write_binary(notifier *n, const std::vector<json> &elements, int width, int height, uint8_t flags) const
+{
+    auto path = m_config_path;
+    const auto dot = path.find_last_of('.');
+    if (dot != std::string::npos && path.find_first_of("/\\", dot) == std::string::npos)
+        path.erase(dot);
+    path += "." IO_LAYOUT_EXTENSION;
+
+    /* The atlas is stored decoded, so the plugin only has to upload it */
+    auto *atlas = IMG_Load(m_texture_path.c_str());
+    auto *pixels = atlas ? SDL_ConvertSurfaceFormat(atlas, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+    SDL_FreeSurface(atlas);
+
+    io_layout_header header{};
+    memcpy(header.magic, IO_LAYOUT_MAGIC, sizeof(header.magic));
+    header.version = IO_LAYOUT_VERSION;
+    header.element_size = sizeof(io_layout_element);
+    header.element_count = uint32_t(elements.size());
+    header.width = uint32_t(width);
+    header.height = uint32_t(height);
+    header.flags = flags;
+    if (pixels) {
+        header.atlas_width = uint32_t(pixels->w);
+        header.atlas_height = uint32_t(pixels->h);
+    }
+
+#if WIN32
+    std::ofstream out(sdl_helper::util_utf8_to_wstring(path), std::ios::binary);
+#else
+    std::ofstream out(path, std::ios::binary);
+#endif
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const auto &j : elements) {
+        const auto e = to_binary(j);
+        out.write(reinterpret_cast<const char *>(&e), sizeof(e));
+    }
+
+    if (pixels) {
+        SDL_LockSurface(pixels);
+        for (int y = 0; y < pixels->h; y++)
+            out.write(static_cast<const char *>(pixels->pixels) + y * pixels->pitch, pixels->w * 4);
+        SDL_UnlockSurface(pixels);
+        SDL_FreeSurface(pixels);
+    }
+
+    if (!out.good()) {
+        n->add_msg(MESSAGE_ERROR, m_helper->format_loc(LANG_MSG_EXPORT_ERROR, path.c_str()));
+        return false;
+    }
+    return true;
+}
+
 void config::write_config(notifier *n)
 {
     if (m_elements.empty()) {
@@ -267,6 +343,7 @@ void config::write_config(notifier *n)
     std::string json_str = cfg.dump();
     util::indent_json(json_str);
     out << json_str;
+    write_binary(n, elements, width, height, flags);
 
     const auto end = SDL_GetTicks();
 
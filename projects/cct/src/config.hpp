@@ -52,6 +52,9 @@ public:
 
     void write_config(notifier *n);
 
+    /* Exports the layout as *.iolayout next to the json file, see iolayout.h */
+    bool write_binary(notifier *n, const std::vector<json> &elements, int width, int height, uint8_t flags) const;
+
     void read_config(notifier *n);
 
     texture *get_texture() const;
@@ -78,6 +78,7 @@
 #define LANG_MSG_GAMEPAD_DISCONNECTED "msg_gamepad_disconnected"
 #define LANG_MSG_ELEMENT_LOAD_ERROR "msg_element_load_error"
 #define LANG_MSG_ELEMENT_EMPTY "msg_element_empty_error"
+#define LANG_MSG_EXPORT_ERROR "msg_export_error"
 
 /* Dialog titles*/
 #define LANG_DIALOG_NEW_ELEMENT "dialog_new_element"
@@ -53,6 +53,11 @@ bool parse_arguments(int argc, char **args)
         DEBUG_LOG(" --mouse=1     enable/disable mouse monitoring.  Off by default\n");
         DEBUG_LOG(" --keyboard=1  enable/disable keyboard monitoring. On by default\n");
         DEBUG_LOG(" --dinput      use direct input on windows. XInput is default\n");
+        DEBUG_LOG(" --send-delay=1  wait up to 1 ms for more events before sending. Events are sent\n");
+        DEBUG_LOG("                 right away by default\n");
+        DEBUG_LOG(" --send-batch=8  send once 8 events are waiting, or after %i ms\n", LISTEN_TIMEOUT);
+        DEBUG_LOG(" --mouse-rate=125 send at most 125 mouse moves per second. Moves in between\n");
+        DEBUG_LOG("                 are merged, no limit by default\n");
         return false;
     }
 
@@ -60,6 +65,9 @@ bool parse_arguments(int argc, char **args)
     cfg.monitor_keyboard = true;
     cfg.monitor_mouse = false;
     cfg.port = 1608;
+    cfg.send = SEND_IMMEDIATE;
+    cfg.send_value = 0;
+    cfg.mouse_rate = 0;
 
     auto const s = sizeof(cfg.username);
     strncpy(cfg.username, args[2], s);
@@ -84,12 +92,21 @@ bool parse_arguments(int argc, char **args)
     std::string arg;
     for (auto i = 4; i < argc; i++) {
         arg = args[i];
-        if (arg.find("--gamepad") != std::string::npos)
+        if (arg.find("--mouse-rate=") != std::string::npos) /* Before --mouse, which it contains */
+            cfg.mouse_rate = uint32_t(strtoul(arg.c_str() + arg.find('=') + 1, nullptr, 0));
+        else if (arg.find("--gamepad") != std::string::npos)
             cfg.monitor_gamepad = arg.find('1') != std::string::npos;
         else if (arg.find("--mouse") != std::string::npos)
             cfg.monitor_mouse = arg.find('1') != std::string::npos;
         else if (arg.find("--keyboard") != std::string::npos)
             cfg.monitor_keyboard = arg.find('1') != std::string::npos;
+        else if (arg.find("--send-delay=") != std::string::npos || arg.find("--send-batch=") != std::string::npos) {
+            cfg.send_value = uint32_t(strtoul(arg.c_str() + arg.find('=') + 1, nullptr, 0));
+            cfg.send = arg.find("--send-delay") != std::string::npos ? SEND_DELAY : SEND_BATCH;
+            /* A delay of 0 or a batch of one event is the same as sending right away */
+            if (cfg.send_value <= (cfg.send == SEND_DELAY ? 0u : 1u))
+                cfg.send = SEND_IMMEDIATE;
+        }
     }
 
     DEBUG_LOG("io_client configuration:\n");
@@ -98,6 +115,14 @@ bool parse_arguments(int argc, char **args)
     DEBUG_LOG(" Keyboard: %s\n", cfg.monitor_keyboard ? "Yes" : "No");
     DEBUG_LOG(" Mouse:    %s\n", cfg.monitor_mouse ? "Yes" : "No");
     DEBUG_LOG(" Gamepad:  %s\n", cfg.monitor_gamepad ? "Yes" : "No");
+    if (cfg.send == SEND_DELAY)
+        DEBUG_LOG(" Send:     after %u ms\n", cfg.send_value);
+    else if (cfg.send == SEND_BATCH)
+        DEBUG_LOG(" Send:     every %u events\n", cfg.send_value);
+    else
+        DEBUG_LOG(" Send:     immediately\n");
+    if (cfg.mouse_rate)
+        DEBUG_LOG(" Mouse:    max. %u moves/s\n", cfg.mouse_rate);
 
     return true;
 }
@@ -29,6 +29,13 @@
 #define DEBUG_LOG(fmt, ...) printf("[%25.25s:%03d]: " fmt, __FUNCTION__, __LINE__, ##__VA_ARGS__)
 
 namespace util {
+/* When the network thread sends the events written by the hooks */
+enum send_policy {
+    SEND_IMMEDIATE, /* Right away, default */
+    SEND_DELAY,     /* Once the oldest event has waited send_value ms */
+    SEND_BATCH      /* Once send_value events are waiting, or after LISTEN_TIMEOUT */
+};
+
 typedef struct {
     bool monitor_gamepad;
     bool monitor_mouse;
@@ -37,6 +44,9 @@ typedef struct {
     gamepad::hook_type::type gamepad_hook_type;
     uint16_t port;
     ip_address ip;
+    send_policy send;
+    uint32_t send_value;
+    uint32_t mouse_rate; /* Max. mouse moves sent per second, 0 for no limit */
 } config;
 
 extern config cfg;
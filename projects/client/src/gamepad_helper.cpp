@@ -21,6 +21,8 @@
 #include "network.hpp"
 #include "client_util.hpp"
 #include <messages.hpp>
+#include <wire.hpp>
+#include <algorithm>
 
 namespace gamepad {
 
@@ -33,25 +35,25 @@ bool start(uint16_t flags)
     hook_instance = hook::make(flags);
     hook_instance->set_plug_and_play(true);
 
-    auto writer = [](const gamepad::input_event *e, uint8_t dev_idx) {
+    auto writer = [](const gamepad::input_event *e, bool axis, uint8_t dev_idx) {
         std::lock_guard<std::mutex> lock(network::buffer_mutex);
-        network::buf.write<uint8_t>(network::MSG_GAMEPAD_EVENT);
-        network::buf.write<uint8_t>(dev_idx);
-        network::buf.write<uint16_t>(e->vc);
-        network::buf.write<float>(e->virtual_value);
-        network::buf.write<uint64_t>(e->time);
+        network::write_pad_event({axis, dev_idx, e->vc, e->virtual_value, e->time});
     };
 
     hook_instance->set_axis_event_handler(
-        [writer](std::shared_ptr<device> d) { writer(d->last_axis_event(), d->get_index()); });
+        [writer](std::shared_ptr<device> d) { writer(d->last_axis_event(), true, d->get_index()); });
     hook_instance->set_button_event_handler(
-        [writer](std::shared_ptr<device> d) { writer(d->last_button_event(), d->get_index()); });
+        [writer](std::shared_ptr<device> d) { writer(d->last_button_event(), false, d->get_index()); });
     hook_instance->set_connect_event_handler([](std::shared_ptr<device> d) {
         std::lock_guard<std::mutex> lock(network::buffer_mutex);
-        network::buf.write<uint8_t>(network::MSG_GAMEPAD_CONNECTED);
+        /* Device index, name length and the name, cut off if it doesn't fit into a frame */
+        const auto length = std::min(d->get_name().length(), size_t(FRAME_MAX_PAYLOAD - 4));
+        network::events.finish(network::buf);
+        const auto frame = network::begin_frame(network::buf, network::MSG_GAMEPAD_CONNECTED);
         network::buf.write<uint8_t>(d->get_index());
-        network::buf.write<uint16_t>(d->get_name().length());
-        network::buf.write(d->get_name().c_str(), d->get_name().length());
+        network::wire::write_varint(network::buf, length);
+        network::buf.write(d->get_name().c_str(), length);
+        network::end_frame(network::buf, frame);
     });
     return hook_instance->start();
 }
@@ -20,12 +20,20 @@
 #include "gamepad_helper.hpp"
 #include "uiohook_helper.hpp"
 #include "client_util.hpp"
+#include <chrono>
 #include <cstdio>
 
+/* Upper bounds of the send latency histogram in microseconds */
+static const uint32_t latency_buckets[] = {100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000};
+#define LATENCY_BUCKET_COUNT (sizeof(latency_buckets) / sizeof(latency_buckets[0]) + 1)
+
+using namespace std::chrono;
+
 namespace network {
 tcp_socket sock = nullptr;
 netlib_socket_set set = nullptr;
 buffer buf;
+event_writer events;
 volatile bool need_refresh = false;
 volatile bool data_block = false;
 volatile bool network_loop = true;
@@ -34,7 +42,111 @@ bool connected = false;
 bool state = false;
 
 std::thread network_thread;
+std::thread send_thread;
 std::mutex buffer_mutex;
+std::condition_variable buffer_cv;
+
+/* All of these are protected by buffer_mutex */
+static bool send_loop = false;                  /* Cleared by close() */
+static uint32_t pending_events = 0;             /* Events written to buf since the last send */
+static steady_clock::time_point first_pending;  /* When the oldest of them was written */
+static uint64_t latency[LATENCY_BUCKET_COUNT]{}; /* Time from the oldest event in a send until it was sent */
+static uint64_t sent_events = 0, sends = 0;
+
+/* The latest mouse move, held back until it's sent so moves in between can
+ * be merged into it. Positions are absolute and the encoding sends the
+ * difference to the previously sent one, so the merged move carries the
+ * final position and the summed delta of all moves it replaced */
+static bool move_pending = false;
+static uiohook_event pending_move;
+static steady_clock::time_point move_since; /* When the first of the merged moves arrived */
+static steady_clock::time_point next_move;  /* Earliest time for the next move, --mouse-rate */
+static uint64_t moves = 0, merged_moves = 0;
+
+/* How long the oldest event is allowed to wait */
+static steady_clock::duration max_wait()
+{
+    switch (util::cfg.send) {
+    case util::SEND_DELAY:
+        return milliseconds(util::cfg.send_value);
+    case util::SEND_BATCH:
+        return milliseconds(LISTEN_TIMEOUT);
+    default:
+        return steady_clock::duration::zero();
+    }
+}
+
+static bool send_due(const steady_clock::time_point now)
+{
+    if (!pending_events)
+        return buf.write_pos() > 0; /* Other messages go out right away */
+    if (util::cfg.send == util::SEND_BATCH && pending_events >= util::cfg.send_value)
+        return true;
+    return now - first_pending >= max_wait();
+}
+
+/* When the pending move should be written to buf. Immediate and batched
+ * sends take it as soon as the rate limit allows, with a delay it merges
+ * all moves within the delay */
+static steady_clock::time_point move_due()
+{
+    auto due = move_since;
+    if (util::cfg.send == util::SEND_DELAY)
+        due += max_wait();
+    return due > next_move ? due : next_move;
+}
+
+static void add_pending(const steady_clock::time_point written)
+{
+    if (!pending_events++)
+        first_pending = written;
+
+    /* The send thread needs to know when the first event arrived, after
+     * that it only has to be woken up if a batch is full */
+    if (pending_events == 1 || (util::cfg.send == util::SEND_BATCH && pending_events == util::cfg.send_value))
+        buffer_cv.notify_one();
+}
+
+static void flush_move()
+{
+    if (!move_pending)
+        return;
+    move_pending = false;
+    events.write(buf, pending_move);
+    if (util::cfg.mouse_rate)
+        next_move = steady_clock::now() + nanoseconds(1000000000ull / util::cfg.mouse_rate);
+    add_pending(move_since);
+}
+
+static void add_latency(const steady_clock::duration time)
+{
+    const auto us = duration_cast<microseconds>(time).count();
+    size_t i = 0;
+    while (i < LATENCY_BUCKET_COUNT - 1 && us >= latency_buckets[i])
+        i++;
+    latency[i]++;
+}
+
+static void print_latency()
+{
+    if (!sends)
+        return;
+
+    if (moves)
+        DEBUG_LOG("Merged %llu of %llu mouse moves\n", (unsigned long long)merged_moves, (unsigned long long)moves);
+    DEBUG_LOG("Sent %llu events in %llu sends. Time from the oldest event in a send until it was sent:\n",
+              (unsigned long long)sent_events, (unsigned long long)sends);
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        if (!latency[i])
+            continue;
+        if (i < LATENCY_BUCKET_COUNT - 1)
+            DEBUG_LOG(" < %6u us: %8llu (%5.1f%%)\n", latency_buckets[i], (unsigned long long)latency[i],
+                      latency[i] * 100.0 / sends);
+        else
+            DEBUG_LOG(">= %6u us: %8llu (%5.1f%%)\n", latency_buckets[i - 1], (unsigned long long)latency[i],
+                      latency[i] * 100.0 / sends);
+    }
+}
 
 bool start_connection()
 {
@@ -71,6 +183,14 @@ bool start_connection()
         return false;
     }
 
+    /* Tells the server how events are encoded, goes out before any events */
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        const auto frame = begin_frame(buf, MSG_WIRE_VERSION);
+        buf.write<uint8_t>(WIRE_VERSION);
+        end_frame(buf, frame);
+    }
+
     start_thread();
     connected = true;
     return true;
@@ -78,7 +198,9 @@ bool start_connection()
 
 void start_thread()
 {
+    send_loop = true;
     network_thread = std::thread(network_thread_method);
+    send_thread = std::thread(send_thread_method);
 }
 
 void network_thread_method()
@@ -90,25 +212,102 @@ void network_thread_method()
             util::close_all();
             break;
         }
+    }
 
-        std::lock_guard<std::mutex> lock(buffer_mutex);
-        /* Reset scroll wheel if no scroll event happened for a bit */
-        if (util::get_ticks() - uiohook::last_scroll_time >= SCROLL_TIMEOUT) {
-            buf.write<uint8_t>(MSG_MOUSE_WHEEL_RESET);
-        }
+    DEBUG_LOG("Network loop exited\n");
+}
 
-        /* Send any data written to the buffer */
-        if (buf.write_pos() > 0) {
+void send_thread_method()
+{
+    buffer out; /* buf is swapped with this, so the hooks can write to buf again while it's sent */
+    auto next_wheel_check = steady_clock::now();
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+
+    while (send_loop) {
+        /* Sleeps until the policy says to send or the next wheel check, hooks
+         * wake it up early if an event has to go out before that */
+        auto wake = next_wheel_check;
+        if (pending_events && first_pending + max_wait() < wake)
+            wake = first_pending + max_wait();
+        if (move_pending && move_due() < wake)
+            wake = move_due();
+        buffer_cv.wait_until(lock, wake);
+        if (!send_loop)
+            break;
 
-            if (!netlib_tcp_send(sock, buf.get(), buf.write_pos())) {
-                DEBUG_LOG("netlib_tcp_send: %s\n", netlib_get_error());
-                break;
+        const auto now = steady_clock::now();
+        if (move_pending && now >= move_due())
+            flush_move();
+        if (now >= next_wheel_check) {
+            next_wheel_check = now + milliseconds(LISTEN_TIMEOUT);
+            /* Reset scroll wheel if no scroll event happened for a bit */
+            if (util::get_ticks() - uiohook::last_scroll_time >= SCROLL_TIMEOUT) {
+                events.finish(buf);
+                write_frame(buf, MSG_MOUSE_WHEEL_RESET);
             }
-            buf.reset();
+        }
+
+        if (!send_due(now))
+            continue;
+
+        events.finish(buf);
+        buf.swap(out);
+        const auto count = pending_events;
+        const auto oldest = first_pending;
+        pending_events = 0;
+
+        lock.unlock();
+        const auto sent = netlib_tcp_send(sock, out.get(), int(out.write_pos()));
+        const auto time = steady_clock::now() - oldest;
+        lock.lock();
+
+        if (sent < int(out.write_pos())) {
+            DEBUG_LOG("netlib_tcp_send: %s\n", netlib_get_error());
+            break;
+        }
+        out.reset();
+
+        if (count) {
+            add_latency(time);
+            sent_events += count;
+            sends++;
         }
     }
 
-    DEBUG_LOG("Network loop exited\n");
+    DEBUG_LOG("Send loop exited\n");
+}
+
+void write_event(const uiohook_event &event)
+{
+    const auto move = event.type == EVENT_MOUSE_MOVED || event.type == EVENT_MOUSE_DRAGGED;
+
+    /* Everything else has to come after the moves before it, and moves
+     * are only merged with moves of the same type */
+    if (move_pending && (!move || pending_move.type != event.type))
+        flush_move();
+
+    if (move) {
+        moves++;
+        if (move_pending) {
+            merged_moves++;
+        } else {
+            move_pending = true;
+            move_since = steady_clock::now();
+            buffer_cv.notify_one(); /* Send thread has to know when it's due */
+        }
+        pending_move = event;
+        return;
+    }
+
+    events.write(buf, event);
+    add_pending(steady_clock::now());
+}
+
+void write_pad_event(const wire_pad_event &event)
+{
+    flush_move();
+    events.write_pad(buf, event);
+    add_pending(steady_clock::now());
 }
 
 int numready = 0;
@@ -165,10 +364,22 @@ void close()
         return;
     state = false;
 
+    /* Stop sending before the disconnect message is sent from this thread */
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        send_loop = false;
+    }
+    buffer_cv.notify_one();
+    if (send_thread.joinable())
+        send_thread.join();
+
     /* Tell server we're disconnecting */
     if (connected) {
-        buf.reset();
-        buf.write<uint8_t>(MSG_CLIENT_DC);
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        print_latency();
+        flush_move();
+        events.finish(buf); /* Events which haven't been sent yet go out with it */
+        write_frame(buf, MSG_CLIENT_DC);
         netlib_tcp_send(sock, buf.get(), buf.write_pos());
     }
 
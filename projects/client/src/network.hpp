@@ -20,7 +20,9 @@
 #include <netlib.h>
 #include <thread>
 #include <buffer.hpp>
+#include <condition_variable>
 #include <mutex>
+#include <wire.hpp>
 #include "util.hpp"
 
 #define BUFFER_SIZE 512
@@ -35,8 +37,11 @@ extern volatile bool network_loop;
 extern volatile bool need_refresh; /* Set to true by other threads */
 extern volatile bool data_block; /* Set to true to prevent other threads from modifying data, which is about to be sent */
 extern buffer buf;
+extern event_writer events; /* Writes input events to buf, also needs buffer_mutex */
 extern std::mutex buffer_mutex;
-extern std::thread network_thread;
+extern std::thread network_thread; /* Receives messages from the server */
+extern std::thread send_thread;    /* Sends buf, see util::send_policy */
+extern std::condition_variable buffer_cv;
 
 bool init();
 bool start_connection();
@@ -45,5 +50,14 @@ bool listen();
 
 void network_thread_method();
 
+void send_thread_method();
+
+/* Write an event to buf, buffer_mutex has to be locked. Consecutive mouse
+ * moves are merged until they're sent (see --mouse-rate), all other events
+ * are written right away and keep their order relative to the moves */
+void write_event(const uiohook_event &event);
+
+void write_pad_event(const wire_pad_event &event);
+
 void close();
 }
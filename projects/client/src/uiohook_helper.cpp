@@ -71,30 +71,26 @@ void dispatch_proc(uiohook_event *const event)
     case EVENT_MOUSE_PRESSED:
     case EVENT_MOUSE_RELEASED:
         if (util::cfg.monitor_mouse) {
-            network::buf.write<uint8_t>(network::MSG_UIOHOOK_EVENT);
-            network::buf.write<uiohook_event>(*event);
+            network::write_event(*event);
         }
         break;
     case EVENT_MOUSE_WHEEL:
         if (util::cfg.monitor_mouse) {
             last_scroll_time = util::get_ticks();
-            network::buf.write<uint8_t>(network::MSG_UIOHOOK_EVENT);
-            network::buf.write<uiohook_event>(*event);
+            network::write_event(*event);
         }
         break;
     case EVENT_MOUSE_MOVED:
     case EVENT_MOUSE_DRAGGED:
         if (util::cfg.monitor_mouse) {
-            network::buf.write<uint8_t>(network::MSG_UIOHOOK_EVENT);
-            network::buf.write<uiohook_event>(*event);
+            network::write_event(*event);
         }
         break;
     //case EVENT_KEY_TYPED: /* TODO: how to handle this */
     case EVENT_KEY_PRESSED:
     case EVENT_KEY_RELEASED:
         if (util::cfg.monitor_keyboard) {
-            network::buf.write<uint8_t>(network::MSG_UIOHOOK_EVENT);
-            network::buf.write<uiohook_event>(*event);
+            network::write_event(*event);
         }
         break;
     default:;
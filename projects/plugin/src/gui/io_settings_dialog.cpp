@@ -21,12 +21,21 @@
 #include "../network/remote_connection.hpp"
 #include "ui_io_settings_dialog.h"
 #include "../util/config.hpp"
+#include "../util/latency.hpp"
 #include "../util/lang.h"
 #include "../util/obs_util.hpp"
 #include "../util/settings.h"
+#include "../hook/backends.hpp"
 #include "../hook/gamepad_hook_helper.hpp"
 #include <libgamepad.hpp>
+#include <QDateTime>
 #include <QDesktopServices>
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QTimer>
 #include <QPair>
 #include <obs-frontend-api.h>
@@ -51,11 +60,16 @@ io_settings_dialog::io_settings_dialog(QWidget *parent) : QDialog(parent, Qt::Di
     connect(ui->btn_refresh_cb, &QPushButton::clicked, this, &io_settings_dialog::RefreshWindowList);
     connect(ui->btn_add, &QPushButton::clicked, this, &io_settings_dialog::AddFilter);
     connect(ui->btn_remove, &QPushButton::clicked, this, &io_settings_dialog::RemoveFilter);
+    connect(ui->btn_latency_reset, &QPushButton::clicked, this, &io_settings_dialog::ResetLatency);
+    connect(ui->btn_latency_export, &QPushButton::clicked, this, &io_settings_dialog::ExportLatency);
 
     /* Load values */
     ui->cb_iohook->setChecked(io_config::uiohook);
     ui->cb_gamepad_hook->setChecked(io_config::gamepad);
     ui->cb_enable_overlay->setChecked(io_config::overlay);
+    ui->cb_record_input->setChecked(io_config::record_input);
+    ui->cb_atlas_cache->setChecked(io_config::atlas_cache);
+    ui->box_atlas_cache_size->setValue(int(io_config::atlas_cache_size));
     ui->cb_enable_control->setChecked(io_config::control);
     ui->cb_enable_remote->setChecked(io_config::remote);
     ui->cb_log->setChecked(io_config::log_flag);
@@ -107,9 +121,21 @@ io_settings_dialog::io_settings_dialog(QWidget *parent) : QDialog(parent, Qt::Di
 void io_settings_dialog::showEvent(QShowEvent *event)
 {
     Q_UNUSED(event)
+    /* Device list and bindings need the gamepad hook, even if no source uses it */
+    if (!m_holds_gamepad)
+        backends::acquire(BACKEND_GAMEPAD);
+    m_holds_gamepad = true;
     RefreshUi();
 }
 
+void io_settings_dialog::hideEvent(QHideEvent *event)
+{
+    Q_UNUSED(event)
+    if (m_holds_gamepad)
+        backends::release(BACKEND_GAMEPAD);
+    m_holds_gamepad = false;
+}
+
 void io_settings_dialog::toggleShowHide()
 {
     setVisible(!isVisible());
@@ -117,6 +143,9 @@ void io_settings_dialog::toggleShowHide()
 
 void io_settings_dialog::RefreshUi()
 {
+    if (ui->tabs->currentWidget() == ui->tab_latency)
+        refresh_latency();
+
     /* Populate client list */
     std::lock_guard<std::mutex> lock(network::mutex);
     if (network::network_flag && network::server_instance && network::server_instance->clients_changed()) {
@@ -232,6 +261,9 @@ void io_settings_dialog::FormAccepted()
     io_config::uiohook = ui->cb_iohook->isChecked();
     io_config::gamepad = ui->cb_gamepad_hook->isChecked();
     io_config::overlay = ui->cb_enable_overlay->isChecked();
+    io_config::record_input = ui->cb_record_input->isChecked();
+    io_config::atlas_cache = ui->cb_atlas_cache->isChecked();
+    io_config::atlas_cache_size = uint32_t(ui->box_atlas_cache_size->value());
 
     io_config::remote = ui->cb_enable_remote->isChecked();
     io_config::log_flag = ui->cb_log->isChecked();
@@ -247,6 +279,123 @@ void io_settings_dialog::FormAccepted()
     io_config::use_dinput = ui->rb_dinput->isChecked();
 }
 
+struct latency_entry {
+    QString name;
+    const char *type;
+    const latency_histogram *histogram;
+};
+
+/* All origins which have recorded anything so far */
+static void collect_latency(std::vector<latency_entry> &entries)
+{
+    for (size_t slot = 0; slot < IO_LATENCY_SLOTS; slot++) {
+        const auto *histogram = latency::find(slot);
+        if (!histogram)
+            continue;
+
+        if (slot == latency::input_slot(0)) {
+            entries.push_back({T_LOCAL_SOURCE, "local", histogram});
+        } else if (slot < IO_LATENCY_PAD_SLOT) {
+            /* Remote origins are numbered the same way as in the source properties */
+            QString name = QString::number(slot);
+            std::lock_guard<std::mutex> lock(network::mutex);
+            auto *client = network::server_instance ? network::server_instance->get_client(uint8_t(slot - 1))
+                                                    : nullptr;
+            if (client)
+                name = utf8_to_qt(client->name());
+            entries.push_back({QString(T_LATENCY_REMOTE).arg(name), "remote", histogram});
+        } else {
+            const auto index = int(slot - IO_LATENCY_PAD_SLOT);
+            QString name;
+            if (libgamepad::state) {
+                std::lock_guard<std::mutex> lock(*libgamepad::hook_instance->get_mutex());
+                for (const auto &dev : libgamepad::hook_instance->get_devices()) {
+                    if (dev->get_index() == index)
+                        name = utf8_to_qt(dev->get_name().c_str());
+                }
+            }
+            entries.push_back({QString(T_LATENCY_GAMEPAD).arg(index).arg(name), "gamepad", histogram});
+        }
+    }
+}
+
+static QString format_latency(uint64_t us)
+{
+    return QString::number(us / 1000.0, 'f', 2) + " ms";
+}
+
+void io_settings_dialog::refresh_latency()
+{
+    std::vector<latency_entry> entries;
+    collect_latency(entries);
+
+    ui->tbl_latency->setRowCount(int(entries.size()));
+    for (int row = 0; row < int(entries.size()); row++) {
+        const auto stats = entries[row].histogram->stats();
+        const QString columns[] = {entries[row].name,        QString::number(stats.samples),
+                                   format_latency(stats.p50), format_latency(stats.p95),
+                                   format_latency(stats.p99), format_latency(stats.max)};
+
+        for (int col = 0; col < 6; col++) {
+            auto *item = ui->tbl_latency->item(row, col);
+            if (!item) {
+                item = new QTableWidgetItem;
+                ui->tbl_latency->setItem(row, col, item);
+            }
+            item->setText(columns[col]);
+        }
+    }
+}
+
+void io_settings_dialog::ResetLatency()
+{
+    latency::reset();
+    refresh_latency();
+}
+
+void io_settings_dialog::ExportLatency()
+{
+    const auto path = QFileDialog::getSaveFileName(this, T_LATENCY_EXPORT, QDir::home().filePath("latency.json"),
+                                                   QString(T_FILTER_JSON_FILES) + " (*.json)");
+    if (path.isEmpty())
+        return;
+
+    std::vector<latency_entry> entries;
+    std::vector<uint32_t> buckets;
+    QJsonArray origins;
+    collect_latency(entries);
+
+    for (const auto &entry : entries) {
+        const auto stats = entry.histogram->stats();
+        QJsonObject origin;
+        origin["name"] = entry.name;
+        origin["type"] = entry.type;
+        origin["samples"] = double(stats.samples);
+        origin["p50_us"] = double(stats.p50);
+        origin["p95_us"] = double(stats.p95);
+        origin["p99_us"] = double(stats.p99);
+        origin["max_us"] = double(stats.max);
+
+        /* Only non empty buckets as [lowest value in µs, count] */
+        QJsonArray histogram;
+        entry.histogram->buckets(buckets);
+        for (size_t i = 0; i < buckets.size(); i++) {
+            if (buckets[i])
+                histogram.append(QJsonArray{double(latency_histogram::bucket_floor(i)), double(buckets[i])});
+        }
+        origin["histogram"] = histogram;
+        origins.append(origin);
+    }
+
+    QJsonObject root;
+    root["time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["origins"] = origins;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson()) < 0)
+        QMessageBox::warning(this, "Error", QString(T_LATENCY_EXPORT_FAILED).arg(path));
+}
+
 io_settings_dialog::~io_settings_dialog()
 {
     delete ui;
@@ -42,6 +42,8 @@ public:
 
     void showEvent(QShowEvent *event) override;
 
+    void hideEvent(QHideEvent *event) override;
+
     void toggleShowHide();
 
 private Q_SLOTS:
@@ -74,12 +76,18 @@ private Q_SLOTS:
 
     void on_box_binding_accepted();
 
+    void ResetLatency();
+
+    void ExportLatency();
+
 private:
     void load_bindings();
     void load_binding(std::shared_ptr<gamepad::cfg::binding> binding);
+    void refresh_latency();
     uint64_t m_last_gamepad_input = 0;
     Ui::io_config_dialog *ui;
     QTimer *m_refresh = nullptr;
+    bool m_holds_gamepad = false; /* Gamepad hook is kept running while the dialog is shown */
 };
 
 extern io_settings_dialog *settings_dialog;
@@ -0,0 +1,119 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "backends.hpp"
+#include "gamepad_hook_helper.hpp"
+#include "uiohook_helper.hpp"
+#include "../util/config.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace backends {
+static std::mutex mutex;
+static std::condition_variable changed;
+static std::thread lifecycle;
+static bool quit = false;
+static uint32_t uiohook_refs = 0, gamepad_refs = 0;
+static bool uiohook_started = false, gamepad_started = false; /* Lifecycle thread only */
+
+static void stop_uiohook()
+{
+    uiohook::stop();
+    uiohook_started = false;
+
+    /* Nothing writes the local input anymore, keys held while the hook stopped
+     * would otherwise show up as pressed once it's started again */
+    local_data::data = {};
+    local_data::snapshot.publish(local_data::data);
+}
+
+/* Starts and stops the backends until they match the references. Only the
+ * latest state counts, so a source which is hidden and shown again before
+ * the thread got to it doesn't restart anything */
+static void lifecycle_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        const auto want_uiohook = uiohook_refs > 0 && io_config::uiohook;
+        const auto want_gamepad = gamepad_refs > 0 && io_config::gamepad;
+        if (want_uiohook == uiohook_started && want_gamepad == gamepad_started) {
+            if (quit)
+                return;
+            changed.wait(lock);
+            continue;
+        }
+
+        lock.unlock();
+        if (want_uiohook && !uiohook_started) {
+            uiohook::start();
+            uiohook_started = true;
+        } else if (!want_uiohook && uiohook_started) {
+            stop_uiohook();
+        }
+
+        if (want_gamepad && !gamepad_started) {
+            libgamepad::start_pad_hook();
+            gamepad_started = true;
+        } else if (!want_gamepad && gamepad_started) {
+            libgamepad::end_pad_hook();
+            gamepad_started = false;
+        }
+        lock.lock();
+    }
+}
+
+void acquire(const uint8_t mask)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (mask & BACKEND_UIOHOOK)
+        uiohook_refs++;
+    if (mask & BACKEND_GAMEPAD)
+        gamepad_refs++;
+
+    if (!lifecycle.joinable()) {
+        quit = false;
+        lifecycle = std::thread(lifecycle_loop);
+    }
+    changed.notify_one();
+}
+
+void release(const uint8_t mask)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (mask & BACKEND_UIOHOOK && uiohook_refs > 0)
+        uiohook_refs--;
+    if (mask & BACKEND_GAMEPAD && gamepad_refs > 0)
+        gamepad_refs--;
+    changed.notify_one();
+}
+
+void stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uiohook_refs = gamepad_refs = 0;
+        quit = true;
+        changed.notify_one();
+    }
+
+    /* The thread stops all backends before it exits */
+    if (lifecycle.joinable())
+        lifecycle.join();
+}
+}
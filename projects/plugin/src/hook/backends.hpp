@@ -0,0 +1,42 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+/* Input backends, which are only running while something reads from them */
+enum backend : uint8_t {
+    BACKEND_UIOHOOK = 1 << 0, /* Local keyboard and mouse */
+    BACKEND_GAMEPAD = 1 << 1  /* Local gamepads */
+};
+
+/* Reference counts for the input backends, so OBS doesn't pay for the hooks
+ * while no source shows local input. A backend is started with its first
+ * reference and stopped once the last one is released. Backends which are
+ * disabled in the settings are never started.
+ * Starting and stopping a hook can take a while (stopping joins its thread),
+ * so it happens on a thread of its own. acquire() and release() only count,
+ * which makes them cheap enough for the video thread */
+namespace backends {
+void acquire(uint8_t mask);
+void release(uint8_t mask);
+
+/* Stops all backends regardless of their references and waits for it, on unload */
+void stop();
+}
@@ -1,8 +1,12 @@
 #include "gamepad_hook_helper.hpp"
+#include "gamepad_monitor.hpp"
 #include <libgamepad.hpp>
 #include "../util/obs_util.hpp"
 #include "../util/log.h"
 #include "../util/config.hpp"
+#include "../util/input_recording.hpp"
+#include "../util/latency.hpp"
+#include <util/platform.h>
 
 namespace libgamepad {
 
@@ -11,11 +15,63 @@ bool state;
 uint16_t last_input;
 uint64_t last_input_time;
 std::mutex last_input_mutex;
+static bool monitored = false; /* Whether gamepad_monitor reads the devices instead of hook_instance's thread */
 
-void start_pad_hook()
+/* time is when the event happened, on the os_gettime_ns() clock */
+static void axis_event(const std::shared_ptr<gamepad::device> &d, const uint64_t time)
+{
+    if (input_recorder::active())
+        input_recorder::record_pad(d->last_axis_event(), true, uint8_t(d->get_index()), time);
+    latency::stamp_pad(d->get_index(), time);
+    std::lock_guard<std::mutex> lock(last_input_mutex);
+    last_input = d->last_axis_event()->native_id;
+    last_input_time = d->last_axis_event()->time;
+}
+
+static void button_event(const std::shared_ptr<gamepad::device> &d, const uint64_t time)
+{
+    if (input_recorder::active())
+        input_recorder::record_pad(d->last_button_event(), false, uint8_t(d->get_index()), time);
+    latency::stamp_pad(d->get_index(), time);
+    std::lock_guard<std::mutex> lock(last_input_mutex);
+    last_input = d->last_button_event()->native_id;
+    last_input_time = d->last_button_event()->time;
+}
+
+#ifdef LINUX
+/* Reads what's queued on libgamepad's file descriptors, the same way hook_instance's thread would */
+static void update_devices(const uint64_t time)
+{
+    std::lock_guard<std::mutex> lock(*hook_instance->get_mutex());
+    for (const auto &d : hook_instance->get_devices()) {
+        for (auto result = d->update(); result != gamepad::update_result::NONE; result = d->update()) {
+            if (result & gamepad::update_result::AXIS)
+                axis_event(d, time);
+            if (result & gamepad::update_result::BUTTON)
+                button_event(d, time);
+        }
+    }
+}
+
+/* Monitor thread. The kernel queued the same events for libgamepad's file descriptors,
+ * so they can be read without blocking. The handlers get the kernel's time of the
+ * newest event, instead of whenever the next poll would have come around */
+static void monitor_events(const gamepad_monitor::pad_event *events, const size_t count)
+{
+    update_devices(events[count - 1].time);
+}
+
+/* Monitor thread, replaces libgamepad's plug and play check. query_devices() locks
+ * the hook mutex itself. New devices report their current state once opened */
+static void monitor_hotplug()
+{
+    hook_instance->query_devices();
+    update_devices(os_gettime_ns());
+}
+#endif
+
+void init_pad_hook()
 {
-    if (state)
-        return;
     uint16_t flags = io_config::use_js ? gamepad::hook_type::JS : gamepad::hook_type::BY_ID;
     flags |= io_config::use_dinput ? gamepad::hook_type::DIRECT_INPUT : gamepad::hook_type::NATIVE_DEFAULT;
     hook_instance = gamepad::hook::make(flags);
@@ -42,16 +98,10 @@ void start_pad_hook()
     };
     gamepad::set_logger(log_pipe, nullptr);
 
-    hook_instance->set_axis_event_handler([](std::shared_ptr<gamepad::device> d) {
-        std::lock_guard<std::mutex> lock(last_input_mutex);
-        last_input = d->last_axis_event()->native_id;
-        last_input_time = d->last_axis_event()->time;
-    });
-    hook_instance->set_button_event_handler([](std::shared_ptr<gamepad::device> d) {
-        std::lock_guard<std::mutex> lock(last_input_mutex);
-        last_input = d->last_button_event()->native_id;
-        last_input_time = d->last_button_event()->time;
-    });
+    /* Only used while hook_instance's thread polls the devices */
+    hook_instance->set_axis_event_handler([](std::shared_ptr<gamepad::device> d) { axis_event(d, os_gettime_ns()); });
+    hook_instance->set_button_event_handler(
+        [](std::shared_ptr<gamepad::device> d) { button_event(d, os_gettime_ns()); });
 
     hook_instance->set_connect_event_handler(
         [](std::shared_ptr<gamepad::device> d) { binfo("'%s' connected", d->get_name().c_str()); });
@@ -61,6 +111,23 @@ void start_pad_hook()
         [](std::shared_ptr<gamepad::device> d) { binfo("'%s' reconnected", d->get_name().c_str()); });
 
     hook_instance->load_bindings(std::string(qt_to_utf8(util_get_data_file("gamepad_bindings.json"))));
+}
+
+void start_pad_hook()
+{
+    if (state || !hook_instance)
+        return;
+
+#ifdef LINUX
+    if (gamepad_monitor::start(io_config::use_js, monitor_events, monitor_hotplug)) {
+        /* Opens the devices, which hook_instance->start() would have done */
+        monitor_hotplug();
+        binfo("gamepad hook started, waiting for gamepad events");
+        monitored = true;
+        state = true;
+        return;
+    }
+#endif
 
     if (hook_instance->start()) {
         binfo("gamepad hook started");
@@ -72,9 +139,26 @@ void start_pad_hook()
 
 void end_pad_hook()
 {
-    hook_instance->stop();
-    hook_instance->save_bindings(std::string(qt_to_utf8(util_get_data_file("gamepad_bindings.json"))));
+    if (!state)
+        return;
+    if (monitored) {
+#ifdef LINUX
+        gamepad_monitor::stop();
+#endif
+        monitored = false;
+    } else {
+        hook_instance->stop();
+    }
     state = false;
+    binfo("gamepad hook stopped");
+}
+
+void free_pad_hook()
+{
+    if (!hook_instance)
+        return;
+    end_pad_hook();
+    hook_instance->save_bindings(std::string(qt_to_utf8(util_get_data_file("gamepad_bindings.json"))));
 }
 
 }
@@ -33,7 +33,14 @@ extern std::mutex last_input_mutex;
 extern std::shared_ptr<gamepad::hook> hook_instance;
 extern bool state;
 
+/* Creates hook_instance and loads the bindings, without looking for devices yet */
+void init_pad_hook();
+
+/* Starts and stops polling the devices, see backends.hpp */
 void start_pad_hook();
 void end_pad_hook();
 
+/* Stops polling and saves the bindings */
+void free_pad_hook();
+
 }
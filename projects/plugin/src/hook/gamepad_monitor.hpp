@@ -0,0 +1,55 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <stdint.h>
+#include <string>
+
+#define GAMEPAD_DEVICE_DIR "/dev/input"
+#define GAMEPAD_BY_ID_DIR "/dev/input/by-id"
+#define GAMEPAD_READ_EVENTS 64 /* Events read from a device file at once */
+
+/* Linux only. Replaces libgamepad's polling thread (which wakes every millisecond)
+ * with a thread that waits in epoll on the joystick device files and only wakes
+ * up on input or when device files appear or disappear (inotify).
+ * The monitor opens its own file descriptors for the devices. The kernel hands
+ * every reader a copy of each event, so once the monitor was woken up the events
+ * are also waiting for libgamepad, which can then read them without blocking */
+namespace gamepad_monitor {
+/* One button or axis event as the kernel reported it */
+struct pad_event {
+    uint64_t time; /* Same clock as os_gettime_ns() */
+    uint16_t code; /* Button or axis number (js), key or abs code (evdev) */
+    int32_t value;
+    bool axis;
+};
+
+/* Called on the monitor thread with the events of one read from a device, count is never 0 */
+typedef std::function<void(const pad_event *events, size_t count)> event_handler;
+
+/* Starts the monitor thread. With js the monitor reads /dev/input/js*, otherwise the
+ * evdev joysticks in /dev/input/by-id, matching what libgamepad reads. on_hotplug is
+ * called on the monitor thread after device files were added or removed.
+ * dir replaces the device directory, which io-bench uses to feed it fifos */
+bool start(bool js, event_handler on_events, std::function<void()> on_hotplug, const std::string &dir = "");
+
+/* Stops and joins the monitor thread */
+void stop();
+}
@@ -0,0 +1,266 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "gamepad_monitor.hpp"
+#include "../util/log.h"
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <linux/joystick.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/* Older headers don't have these yet */
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+namespace gamepad_monitor {
+struct device_file {
+    int fd;
+    bool monotonic; /* evdev only, whether the kernel stamps the events with the monotonic clock */
+};
+
+static std::thread monitor;
+static event_handler on_events;
+static std::function<void()> on_hotplug;
+static bool watch_js = true;
+static std::string device_dir;
+static int epoll_fd = -1, inotify_fd = -1, stop_fd = -1;
+static std::vector<device_file> devices;
+
+static uint64_t clock_ns(const clockid_t clock)
+{
+    timespec ts{};
+    clock_gettime(clock, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+static bool is_gamepad(const std::string &name)
+{
+    if (watch_js)
+        return name.compare(0, 2, "js") == 0;
+    static const std::string suffix = "-event-joystick";
+    return name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static void close_devices()
+{
+    for (const auto &device : devices) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, device.fd, nullptr);
+        close(device.fd);
+    }
+    devices.clear();
+}
+
+/* Reopens all device files, only happens on hotplug so there's no need to track them one by one */
+static void scan_devices()
+{
+    close_devices();
+
+    /* by-id only exists while at least one device with an id is connected,
+     * adding a watch which already exists does nothing */
+    if (!watch_js)
+        inotify_add_watch(inotify_fd, device_dir.c_str(), IN_CREATE | IN_DELETE);
+
+    auto *dir = opendir(device_dir.c_str());
+    if (!dir)
+        return;
+
+    while (const auto *entry = readdir(dir)) {
+        if (!is_gamepad(entry->d_name))
+            continue;
+
+        const auto fd = open((device_dir + "/" + entry->d_name).c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        /* Only affects this file descriptor, libgamepad's copy keeps its own clock */
+        int clock = CLOCK_MONOTONIC;
+        const device_file device = {fd, !watch_js && ioctl(fd, EVIOCSCLOCKID, &clock) == 0};
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0)
+            devices.emplace_back(device);
+        else
+            close(fd);
+    }
+    closedir(dir);
+}
+
+static void read_js(const js_event *buf, const size_t count, std::vector<pad_event> &events)
+{
+    /* js timestamps are milliseconds on a clock of their own,
+     * the time they were read at is as close as it gets */
+    const auto now = clock_ns(CLOCK_MONOTONIC);
+    for (size_t i = 0; i < count; i++) {
+        /* Events flagged with init describe the state when the device was opened */
+        if (buf[i].type == JS_EVENT_BUTTON || buf[i].type == JS_EVENT_AXIS)
+            events.push_back({now, buf[i].number, buf[i].value, buf[i].type == JS_EVENT_AXIS});
+    }
+}
+
+static void read_evdev(const device_file &device, const input_event *buf, const size_t count,
+                       std::vector<pad_event> &events)
+{
+    /* Without EVIOCSCLOCKID the events are stamped with the real time clock */
+    const auto offset = device.monotonic ? 0 : clock_ns(CLOCK_REALTIME) - clock_ns(CLOCK_MONOTONIC);
+    for (size_t i = 0; i < count; i++) {
+        const auto &ev = buf[i];
+        if (ev.type != EV_KEY && ev.type != EV_ABS)
+            continue;
+        const auto time = uint64_t(ev.input_event_sec) * 1000000000ull + uint64_t(ev.input_event_usec) * 1000ull;
+        events.push_back({time - offset, ev.code, ev.value, ev.type == EV_ABS});
+    }
+}
+
+/* Reads everything the device has, returns false if it's gone. It's removed once inotify reports it */
+static bool read_device(const device_file &device, std::vector<pad_event> &events)
+{
+    union {
+        js_event js[GAMEPAD_READ_EVENTS];
+        input_event evdev[GAMEPAD_READ_EVENTS];
+    } buf;
+
+    for (;;) {
+        const auto len = read(device.fd, &buf, watch_js ? sizeof(buf.js) : sizeof(buf.evdev));
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0)
+            return len < 0 && errno == EAGAIN;
+
+        if (watch_js)
+            read_js(buf.js, size_t(len) / sizeof(js_event), events);
+        else
+            read_evdev(device, buf.evdev, size_t(len) / sizeof(input_event), events);
+    }
+}
+
+static void monitor_loop()
+{
+    epoll_event events[16];
+    std::vector<pad_event> input;
+    input.reserve(GAMEPAD_READ_EVENTS);
+
+    for (;;) {
+        const auto count = epoll_wait(epoll_fd, events, 16, -1);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            break;
+
+        auto rescan = false;
+        for (int i = 0; i < count; i++) {
+            const auto fd = events[i].data.fd;
+            if (fd == stop_fd)
+                return;
+
+            if (fd == inotify_fd) {
+                alignas(struct inotify_event) char buf[4096];
+                while (read(inotify_fd, buf, sizeof(buf)) > 0) {
+                }
+                rescan = true;
+                continue;
+            }
+
+            for (const auto &device : devices) {
+                if (device.fd != fd)
+                    continue;
+
+                input.clear();
+                /* Disconnected devices stay readable until they're closed */
+                if (!read_device(device, input))
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                if (!input.empty())
+                    on_events(input.data(), input.size());
+                break;
+            }
+        }
+
+        if (rescan) {
+            scan_devices();
+            on_hotplug();
+        }
+    }
+}
+
+static void close_fds()
+{
+    close_devices();
+    for (auto *fd : {&inotify_fd, &stop_fd, &epoll_fd}) {
+        if (*fd >= 0)
+            close(*fd);
+        *fd = -1;
+    }
+}
+
+bool start(const bool js, event_handler events, std::function<void()> hotplug, const std::string &dir)
+{
+    watch_js = js;
+    on_events = std::move(events);
+    on_hotplug = std::move(hotplug);
+    device_dir = dir.empty() ? (js ? GAMEPAD_DEVICE_DIR : GAMEPAD_BY_ID_DIR) : dir;
+
+    /* by-id can be missing, so the directory it will be created in is watched as well */
+    const auto watched = js ? device_dir : device_dir.substr(0, device_dir.find_last_of('/'));
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || inotify_fd < 0 || stop_fd < 0 ||
+        inotify_add_watch(inotify_fd, watched.c_str(), IN_CREATE | IN_DELETE) < 0) {
+        bwarn("Couldn't watch %s for gamepads, falling back to polling", watched.c_str());
+        close_fds();
+        return false;
+    }
+
+    for (const auto fd : {inotify_fd, stop_fd}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    scan_devices();
+    monitor = std::thread(monitor_loop);
+    return true;
+}
+
+void stop()
+{
+    if (!monitor.joinable())
+        return;
+
+    const uint64_t one = 1;
+    if (write(stop_fd, &one, sizeof(one)) != sizeof(one))
+        bwarn("Couldn't wake the gamepad monitor");
+    monitor.join();
+    close_fds();
+}
+}
@@ -18,8 +18,7 @@
 
 #pragma once
 #include "../util/input_data.hpp"
-#include <map>
-#include <mutex>
+#include "../util/input_recording.hpp"
 #include <netlib.h>
 #include <uiohook.h>
 #include <util/platform.h>
@@ -38,17 +37,33 @@ inline void check_wheel()
     }
 }
 
+/* Runs on the hook thread, which is the only writer of local_data::data */
 inline void process_event(uiohook_event *event)
 {
-    std::lock_guard<std::mutex> lock(local_data::data_mutex);
+    if (input_recorder::active())
+        input_recorder::record(event);
+
+    /* uiohook's event->time uses a different clock on every platform, so
+     * events are stamped here for latency stats and the press queue */
+    const auto now = os_gettime_ns();
     local_data::data.dispatch_uiohook_event(event);
+    local_data::data.event_time = now;
     if (event->type == EVENT_MOUSE_WHEEL)
-        last_scroll_time = os_gettime_ns();
+        last_scroll_time = now;
     check_wheel();
+    local_data::snapshot.publish(local_data::data);
+
+    /* Queued after publishing, so a reader which sees the release
+     * in the snapshot is guaranteed to also find the press */
+    const auto code = input_data::press_code(event);
+    if (code != VC_NONE)
+        local_data::presses.push({now, code});
 }
 
+/* Starts the hook thread, see backends.hpp */
 void start();
 
+/* Stops the hook thread again, once per start() */
 void stop();
 
 }
@@ -31,7 +31,6 @@ namespace uiohook {
 
 uint64_t last_scroll_time = 0; /* System time at last scroll event */
 bool state = false;
-std::mutex data_mutex;
 
 static pthread_t hook_thread;
 static pthread_mutex_t hook_running_mutex;
@@ -146,6 +145,14 @@ int hook_enable()
 
 void stop()
 {
+    if (state) {
+        /* hook_run() returns once the hook is disabled */
+        hook_stop();
+        pthread_join(hook_thread, nullptr);
+        state = false;
+        blog(LOG_INFO, "[input-overlay] uiohook stopped");
+    }
+
     pthread_mutex_destroy(&hook_running_mutex);
     pthread_mutex_destroy(&hook_control_mutex);
     pthread_cond_destroy(&hook_control_cond);
@@ -30,7 +30,6 @@ namespace uiohook {
 
 uint64_t last_scroll_time = 0; /* System time at last scroll event */
 bool state = false;
-std::mutex data_mutex;
 
 static HANDLE hook_thread;
 static HANDLE hook_running_mutex;
@@ -86,6 +85,14 @@ bool logger_proc(const unsigned int level, const char *format, ...)
 
 void stop()
 {
+    if (state) {
+        /* hook_run() returns once the hook is disabled */
+        hook_stop();
+        WaitForSingleObject(hook_thread, INFINITE);
+        state = false;
+        blog(LOG_INFO, "[input-overlay] uiohook stopped");
+    }
+
     CloseHandle(hook_thread);
     CloseHandle(hook_running_mutex);
     CloseHandle(hook_control_mutex);
@@ -17,18 +17,27 @@
  *************************************************************************/
 
 #include <QAction>
+#include <QDateTime>
+#include <QDir>
 #include <QMainWindow>
 #include <obs-frontend-api.h>
 #include <obs-module.h>
 #include <util/config-file.h>
+#include <string.h>
 
 #include "gui/io_settings_dialog.hpp"
+#include "hook/backends.hpp"
 #include "hook/gamepad_hook_helper.hpp"
 #include "hook/uiohook_helper.hpp"
 #include "network/remote_connection.hpp"
 #include "sources/input_source.hpp"
 #include "util/config.hpp"
+#include "util/file_watcher.hpp"
+#include "util/input_recording.hpp"
+#include "util/latency.hpp"
+#include "util/load_worker.hpp"
 #include "util/lang.h"
+#include "util/obs_util.hpp"
 #include "util/log.h"
 
 #ifdef LINUX
@@ -40,6 +49,35 @@ extern void cleanupDisplay();
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("input-overlay", "en-US")
 
+/* Records input alongside OBS recordings, the file is put next to the video
+ * so both can be lined up again when replaying. The hooks are kept running
+ * while recording, even if no source shows local input */
+static bool recording_input = false;
+
+static void frontend_event(enum obs_frontend_event event, void *)
+{
+    if (event == OBS_FRONTEND_EVENT_RECORDING_STARTED && io_config::record_input) {
+        auto *profile = obs_frontend_get_profile_config();
+        const char *mode = config_get_string(profile, "Output", "Mode");
+        const auto advanced = mode && strcmp(mode, "Advanced") == 0;
+        const char *dir = advanced ? config_get_string(profile, "AdvOut", "RecFilePath")
+                                   : config_get_string(profile, "SimpleOutput", "FilePath");
+        if (!dir)
+            return;
+
+        const auto name = QDateTime::currentDateTime().toString("'input_'yyyy-MM-dd_hh-mm-ss'." IO_REC_EXTENSION "'");
+        if (!recording_input)
+            backends::acquire(BACKEND_UIOHOOK | BACKEND_GAMEPAD);
+        recording_input = true;
+        input_recorder::start(qt_to_utf8(QDir(utf8_to_qt(dir)).filePath(name)));
+    } else if (event == OBS_FRONTEND_EVENT_RECORDING_STOPPED || event == OBS_FRONTEND_EVENT_EXIT) {
+        input_recorder::stop();
+        if (recording_input)
+            backends::release(BACKEND_UIOHOOK | BACKEND_GAMEPAD);
+        recording_input = false;
+    }
+}
+
 bool obs_module_load()
 {
     binfo("Loading v%s build time %s", INPUT_OVERLAY_VERSION, BUILD_TIME);
@@ -49,11 +87,9 @@ bool obs_module_load()
     if (io_config::overlay)
         sources::register_overlay_source();
 
-    if (io_config::uiohook)
-        uiohook::start();
-
+    /* The hooks themselves are started once a source needs them, see backends.hpp */
     if (io_config::gamepad)
-        libgamepad::start_pad_hook();
+        libgamepad::init_pad_hook();
 
     if (io_config::remote) {
         network::local_input = io_config::gamepad || io_config::uiohook;
@@ -75,6 +111,7 @@ bool obs_module_load()
 
     const auto menu_cb = [] { settings_dialog->toggleShowHide(); };
     QAction::connect(menu_action, &QAction::triggered, menu_cb);
+    obs_frontend_add_event_callback(frontend_event, nullptr);
 
     return true;
 }
@@ -84,8 +121,13 @@ void obs_module_unload()
     /* Save config values again */
     io_config::save();
 
-    libgamepad::end_pad_hook();
-    uiohook::stop();
+    obs_frontend_remove_event_callback(frontend_event, nullptr);
+    input_recorder::stop();
+    backends::stop();
+    libgamepad::free_pad_hook();
+    load_worker::stop();
+    file_watcher::stop();
+    latency::release_all();
 
 #ifdef LINUX
     cleanupDisplay();
@@ -17,13 +17,16 @@
  *************************************************************************/
 
 #include "io_client.hpp"
+#include "remote_connection.hpp"
 #include "../util/config.hpp"
 #include <keycodes.h>
+#include <stdlib.h>
+#include <util/platform.h>
 
 #include "src/util/log.h"
 
 namespace network {
-io_client::io_client(char *name, tcp_socket socket, uint8_t id) : m_holder()
+io_client::io_client(char *name, client_socket socket, uint8_t id) : m_holder()
 {
     m_name = name;
     m_socket = socket;
@@ -33,11 +36,11 @@ io_client::io_client(char *name, tcp_socket socket, uint8_t id) : m_holder()
 
 io_client::~io_client()
 {
-    delete m_name;
-    netlib_tcp_close(m_socket);
+    free(m_name); /* Allocated by read_text */
+    close_socket(m_socket);
 }
 
-tcp_socket io_client::socket() const
+client_socket io_client::socket() const
 {
     return m_socket;
 }
@@ -57,24 +60,120 @@ input_data *io_client::get_data()
     return &m_holder;
 }
 
-bool io_client::read_event(buffer &buf, const message msg)
+void io_client::publish_data()
 {
-    auto flag = true;
+    m_snapshot.publish(m_holder);
+}
+
+const input_data &io_client::read_data()
+{
+    return m_snapshot.read();
+}
 
-    if (msg == MSG_UIOHOOK_EVENT) {
-        auto *event = buf.read<uiohook_event>();
-        if (event) {
+bool io_client::read_events(const uint8_t *payload, const size_t size)
+{
+    wire::reader reader(payload, size);
+    uiohook_event event;
+    wire_pad_event pad;
+
+    while (!reader.done()) {
+        const auto tag = wire::read_event(reader, m_wire, event, pad);
+        if (!tag)
+            return false;
 
-        } else {
-            flag = false;
+        if (tag < WIRE_PAD_BUTTON) {
+            /* The event time is from the client's clock, which isn't synced with
+             * ours, so remote latency is measured from the moment it arrived */
+            m_holder.dispatch_uiohook_event(&event);
+            m_holder.event_time = os_gettime_ns();
         }
-    } else if (msg == MSG_GAMEPAD_EVENT) {
+        /* Gamepad events aren't applied to remote clients yet */
+    }
+    return true;
+}
+
+uint8_t *io_client::receive_space(size_t &length)
+{
+    return m_recv.write_space(length);
+}
+
+void io_client::received(const size_t length)
+{
+    m_recv.commit(length);
+    read_frames();
+}
+
+void io_client::receive(const void *data, size_t length)
+{
+    /* Reading frames makes room for the rest, so any amount of data fits */
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    while (length > 0 && m_valid) {
+        const auto written = m_recv.write(bytes, length);
+        bytes += written;
+        length -= written;
+        read_frames();
     }
+}
+
+void io_client::read_frames()
+{
+    uint8_t header[FRAME_HEADER_SIZE];
 
-    if (!flag)
-        berr("Couldn't read event for client %s. Error: %s", name(), netlib_get_error());
+    /* The buffer can contain multiple frames, the last one might not be complete yet */
+    while (m_valid && m_recv.peek(header, sizeof(header))) {
+        const auto msg = message(header[0]);
+        const size_t size = size_t(header[1]) << 8 | header[2];
 
-    return flag;
+        if (size > FRAME_MAX_PAYLOAD) {
+            /* Nothing after this can be trusted to be aligned to a frame */
+            berr("Received invalid frame (%zu bytes) from %s. Closed connection", size, name());
+            m_recv.clear();
+            mark_invalid();
+            break;
+        }
+
+        if (m_recv.size() < sizeof(header) + size)
+            break; /* Rest of it is still on the way */
+
+        m_recv.consume(sizeof(header));
+        const auto *payload = m_recv.contiguous(size);
+        if (!payload) {
+            m_recv.peek(m_frame, size);
+            payload = m_frame;
+        }
+        read_message(msg, payload, size);
+        m_recv.consume(size);
+    }
+}
+
+void io_client::read_message(const message msg, const uint8_t *payload, const size_t size)
+{
+    switch (msg) {
+    case MSG_WIRE_VERSION:
+        m_wire_version = size == 1 && payload[0] == WIRE_VERSION;
+        if (!m_wire_version) {
+            berr("%s uses protocol version %i, expected %i. Make sure client and plugin are the same version",
+                 name(), size ? payload[0] : 0, WIRE_VERSION);
+            mark_invalid();
+        }
+        break;
+    case MSG_INPUT_EVENTS:
+        /* Events are delta encoded, so nothing after a broken frame can be read either */
+        if (!m_wire_version || !read_events(payload, size)) {
+            berr("Failed to receive event data from %s. Closed connection", name());
+            mark_invalid();
+        }
+        break;
+    case MSG_MOUSE_WHEEL_RESET:
+        m_holder.last_wheel_event = {};
+        break;
+    case MSG_CLIENT_DC:
+        mark_invalid();
+        break;
+    default:
+        /* Unknown messages can be skipped since the frame says how long they are */
+        break;
+    }
 }
 
 bool io_client::valid() const
@@ -19,31 +19,67 @@
 #pragma once
 
 #include "../util/input_data.hpp"
-#include <buffer.hpp>
+#include "../util/ring_buffer.hpp"
+#include <wire.hpp>
 #include <messages.hpp>
 #include <netlib.h>
 
+/* On Linux the server runs its own epoll loop on plain non-blocking
+ * sockets (see io_server_linux.cpp), other platforms use netlib */
+#ifdef LINUX
+typedef int client_socket;
+#define INVALID_CLIENT_SOCKET -1
+#else
+typedef tcp_socket client_socket;
+#define INVALID_CLIENT_SOCKET nullptr
+#endif
+
+/* Received data that doesn't form a complete frame yet, has to fit at least
+ * one frame of FRAME_MAX_PAYLOAD */
+#define CLIENT_RECV_BUFFER_SIZE 8192
+
 namespace network {
 class io_client {
 public:
-    io_client(char *name, tcp_socket socket, uint8_t id);
+    io_client(char *name, client_socket socket, uint8_t id);
 
     ~io_client();
 
-    tcp_socket socket() const;
+    client_socket socket() const;
     const char *name() const;
     uint8_t id() const;
     input_data *get_data();
-    bool read_event(buffer &buf, message msg);
+    /* Publishes the current state to the snapshot, network thread only */
+    void publish_data();
+    /* Latest published state, see triple_buffer::read */
+    const input_data &read_data();
+    /* Reads a MSG_INPUT_EVENTS payload, false if it's malformed */
+    bool read_events(const uint8_t *payload, size_t size);
+
+    /* Free part of the receive buffer, recv() can write into it directly.
+     * Pass the number of bytes written to received(). Network thread only */
+    uint8_t *receive_space(size_t &length);
+    /* Reads all frames completed by the last length received bytes */
+    void received(size_t length);
+    /* Appends data to the receive buffer and reads all complete frames */
+    void receive(const void *data, size_t length);
     void mark_invalid();
     bool valid() const;
 
 private:
-    input_data m_holder;
-    tcp_socket m_socket;
+    void read_frames();
+    void read_message(message msg, const uint8_t *payload, size_t size);
+
+    input_data m_holder;                   /* Only written to by the network thread */
+    triple_buffer<input_data> m_snapshot; /* Published copy of m_holder */
+    client_socket m_socket;
     uint8_t m_id;
     /* Set to false if this client should be disconnected on next roundtrip */
     bool m_valid;
     char *m_name;
+    wire_state m_wire;           /* Decoder state of the event encoding, see wire.hpp */
+    bool m_wire_version = false; /* Set once the client said it uses WIRE_VERSION */
+    ring_buffer<CLIENT_RECV_BUFFER_SIZE> m_recv; /* Partial frames are kept here until they're complete */
+    uint8_t m_frame[FRAME_MAX_PAYLOAD];        /* Payloads which wrap around the end of m_recv */
 };
 }
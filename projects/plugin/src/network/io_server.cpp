@@ -26,101 +26,16 @@
 
 #include "src/util/log.h"
 
-static netlib_socket_set sockets = nullptr;
-
 namespace network {
 std::mutex mutex;
 
-io_server::io_server(const uint16_t port) : m_server(nullptr)
+io_server::io_server(const uint16_t port)
 {
-    sockets = nullptr;
     m_num_clients = 0;
     m_ip.port = port;
     m_last_refresh = os_gettime_ns();
 }
 
-io_server::~io_server()
-{
-    m_clients.clear();
-}
-
-bool io_server::init()
-{
-    auto flag = true;
-
-    if (netlib_resolve_host(&m_ip, nullptr, m_ip.port) == -1) {
-        berr("netlib_resolve_host failed: %s.", netlib_get_error());
-        flag = false;
-    } else {
-        const auto ipaddr = netlib_swap_BE32(m_ip.host);
-        berr("Remote connection open on %d.%d.%d.%d:%hu", ipaddr >> 24, ipaddr >> 16 & 0xff, ipaddr >> 8 & 0xff,
-             ipaddr & 0xff, m_ip.port);
-
-        m_server = netlib_tcp_open(&m_ip);
-        m_buffer.resize(8192); // Most likely will never need more than 8KB
-        if (!m_server) {
-            berr("netlib_tcp_open failed: %s", netlib_get_error());
-            flag = false;
-        }
-    }
-    return flag;
-}
-
-void io_server::listen(int &numready)
-{
-    if (create_sockets())
-        numready = netlib_check_socket_set(sockets, LISTEN_TIMEOUT);
-}
-
-tcp_socket io_server::socket() const
-{
-    return m_server;
-}
-
-void io_server::update_clients()
-{
-    std::lock_guard<std::mutex> lock(mutex);
-
-    for (const auto &client : m_clients) {
-        if (netlib_socket_ready(client->socket())) {
-            /* Receive input data */
-            m_buffer.reset();
-            const int read = netlib_tcp_recv(client->socket(), static_cast<void *>(m_buffer.get()), m_buffer.length());
-
-            if (read < 0) {
-                berr("Failed to receive buffer from %s. Closed connection", client->name());
-                client->mark_invalid();
-                continue;
-            }
-
-            while (m_buffer.read_pos() < read) /* Buffer can contain multiple messages */
-            {
-                const auto msg = read_msg_from_buffer(m_buffer);
-
-                switch (msg) {
-                case MSG_UIOHOOK_EVENT:
-                case MSG_GAMEPAD_EVENT:
-                    if (!client->read_event(m_buffer, msg))
-                        berr("Failed to receive event data from %s.", client->name());
-                    break;
-                case MSG_MOUSE_WHEEL_RESET:
-                    client->get_data()->last_wheel_event = {};
-                    break;
-                case MSG_CLIENT_DC:
-                    client->mark_invalid();
-                    break;
-                case MSG_GAMEPAD_CONNECTED:
-                    break;
-                default:
-                case MSG_END_BUFFER:
-                case MSG_INVALID:
-                    break;
-                }
-            }
-        }
-    }
-}
-
 void io_server::get_clients(std::vector<const char *> &v)
 {
     for (const auto &client : m_clients) {
@@ -192,7 +107,7 @@ io_client *io_server::get_client(const uint8_t id)
     return nullptr;
 }
 
-void io_server::add_client(tcp_socket socket, char *name)
+io_client *io_server::add_client(client_socket socket, char *name)
 {
     std::lock_guard<std::mutex> lock(mutex);
 
@@ -201,15 +116,15 @@ void io_server::add_client(tcp_socket socket, char *name)
     if (!strlen(name)) {
         binfo("Disconnected %s: Invalid name", name);
         send_message(socket, MSG_NAME_INVALID);
-        netlib_tcp_close(socket);
-        return;
+        close_socket(socket);
+        return nullptr;
     }
 
     if (!unique_name(name)) {
         binfo("Disconnected %s: Name already in use", name);
         send_message(socket, MSG_NAME_NOT_UNIQUE);
-        netlib_tcp_close(socket);
-        return;
+        close_socket(socket);
+        return nullptr;
     }
 
     binfo("Received connection from '%s'.", name);
@@ -217,6 +132,7 @@ void io_server::add_client(tcp_socket socket, char *name)
     m_clients_changed = true;
     m_clients.emplace_back(new io_client(name, socket, m_num_clients));
     m_num_clients++;
+    return m_clients.back().get();
 }
 
 bool io_server::unique_name(char *name)
@@ -243,24 +159,4 @@ void io_server::fix_name(char *name)
         name[pos] = '_';
     }
 }
-
-bool io_server::create_sockets()
-{
-    if (sockets)
-        netlib_free_socket_set(sockets);
-
-    sockets = netlib_alloc_socket_set(m_num_clients + 1);
-    if (!sockets) {
-        berr("netlib_alloc_socket_set failed with %i clients.", m_num_clients + 1);
-        network_flag = false;
-        return false;
-    }
-
-    netlib_tcp_add_socket(sockets, m_server);
-
-    for (const auto &client : m_clients)
-        netlib_tcp_add_socket(sockets, client->socket());
-
-    return true;
-}
 }
@@ -24,11 +24,14 @@
 #include <netlib.h>
 #include <obs-module.h>
 #include <vector>
-#include <buffer.hpp>
 
 #ifdef _WIN32
 #include <Windows.h>
 #endif
+#ifdef LINUX
+#include <map>
+#include <string>
+#endif
 #define LISTEN_TIMEOUT 25
 
 namespace network {
@@ -42,11 +45,17 @@ public:
 
     bool init();
 
-    void listen(int &numready);
+    /* Accepts clients and receives their input until network_flag is
+     * cleared, network thread only. Linux waits in epoll and reads data as
+     * soon as it arrives (io_server_linux.cpp), other platforms check the
+     * netlib socket set every LISTEN_TIMEOUT ms (io_server_win.cpp) */
+    void run();
 
-    tcp_socket socket() const;
-    void add_client(tcp_socket socket, char *name);
-    void update_clients();
+    /* Makes run() notice a cleared network_flag right away */
+    void wake();
+
+    /* Returns nullptr and closes the socket if the name was refused */
+    io_client *add_client(client_socket socket, char *name);
     void get_clients(std::vector<const char *> &v);
     void get_clients(obs_property_t *prop, bool enable_local);
     bool clients_changed() const;
@@ -64,14 +73,25 @@ private:
 
     static void fix_name(char *name);
 
+#ifdef LINUX
+    void accept_clients();
+    void read_name(int fd);
+    void receive(io_client *client);
+
+    int m_listen_fd = -1, m_epoll_fd = -1, m_wake_fd = -1;
+    std::map<int, std::string> m_pending; /* Connections which haven't sent their name yet */
+#else
+    void listen(int &numready);
+    void update_clients();
     bool create_sockets();
 
+    tcp_socket m_server = nullptr;
+#endif
+
     uint64_t m_last_refresh = 0;
-    buffer m_buffer;                /* Used for temporarily storing sent data */
     bool m_clients_changed = false; /* Set to true on connection/disconnect and false after get_clients() */
     uint8_t m_num_clients;
     ip_address m_ip{};
-    tcp_socket m_server;
     std::vector<std::unique_ptr<io_client>> m_clients;
 };
 }
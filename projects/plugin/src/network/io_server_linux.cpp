@@ -0,0 +1,276 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/* Server loop on epoll. Sockets are non-blocking and edge triggered, so the
+ * thread sleeps until a client sends something or connects and then reads
+ * everything that arrived. The only timeout left is the refresh interval */
+
+#include "io_server.hpp"
+#include "remote_connection.hpp"
+#include "../util/config.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "src/util/log.h"
+
+#define EPOLL_MAX_EVENTS 64
+#define MAX_NAME_LENGTH 256 /* Including the terminator, longer names are refused */
+
+namespace network {
+static bool watch(const int epoll_fd, const int fd, const uint32_t events)
+{
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+io_server::~io_server()
+{
+    m_clients.clear();
+    for (const auto &pending : m_pending)
+        close(pending.first);
+    for (const auto fd : {m_listen_fd, m_epoll_fd, m_wake_fd}) {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+bool io_server::init()
+{
+    m_listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_listen_fd < 0 || m_epoll_fd < 0 || m_wake_fd < 0) {
+        berr("Couldn't create server socket: %s", strerror(errno));
+        return false;
+    }
+
+    const int yes = 1;
+    setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(m_ip.port);
+    if (bind(m_listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        ::listen(m_listen_fd, SOMAXCONN) < 0) {
+        berr("Couldn't listen on port %hu: %s", m_ip.port, strerror(errno));
+        return false;
+    }
+
+    if (!watch(m_epoll_fd, m_listen_fd, EPOLLIN | EPOLLET) || !watch(m_epoll_fd, m_wake_fd, EPOLLIN)) {
+        berr("epoll_ctl failed: %s", strerror(errno));
+        return false;
+    }
+
+    binfo("Remote connection open on 0.0.0.0:%hu", m_ip.port);
+    return true;
+}
+
+void io_server::run()
+{
+    epoll_event events[EPOLL_MAX_EVENTS];
+
+    while (network_flag) {
+        roundtrip();
+
+        /* Only refreshing the clients needs a timeout, input wakes the thread right away */
+        const auto count = epoll_wait(m_epoll_fd, events, EPOLL_MAX_EVENTS, io_config::refresh_rate);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0) {
+            berr("epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            const auto fd = events[i].data.fd;
+            if (fd == m_wake_fd) {
+                uint64_t value;
+                if (read(m_wake_fd, &value, sizeof(value)) < 0)
+                    bdebug("Couldn't reset server wake up: %s", strerror(errno));
+            } else if (fd == m_listen_fd) {
+                accept_clients();
+            } else if (m_pending.count(fd)) {
+                read_name(fd);
+            } else {
+                /* The client list is only modified on this thread, so no lock is needed to search it */
+                for (const auto &client : m_clients) {
+                    if (client->socket() == fd) {
+                        receive(client.get());
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void io_server::wake()
+{
+    const uint64_t one = 1;
+    if (write(m_wake_fd, &one, sizeof(one)) < 0)
+        bdebug("Couldn't wake the server thread: %s", strerror(errno));
+}
+
+void io_server::accept_clients()
+{
+    for (;;) {
+        const auto fd = accept4(m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                berr("accept failed: %s", strerror(errno));
+            break;
+        }
+
+        /* Only the one byte pings and refreshes are sent, those shouldn't wait for more data */
+        const int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        if (!watch(m_epoll_fd, fd, EPOLLIN | EPOLLRDHUP | EPOLLET)) {
+            berr("epoll_ctl failed: %s", strerror(errno));
+            close(fd);
+            continue;
+        }
+
+        binfo("Accepted connection...");
+        m_pending.emplace(fd, std::string());
+        /* Clients send their name right after connecting, it might be here already */
+        read_name(fd);
+    }
+}
+
+void io_server::read_name(const int fd)
+{
+    /* The name is sent like read_text() expects it: Its length (big endian, including the
+     * terminator) and the name itself. Only that much is read here, anything after it is
+     * input and is left in the socket for receive() */
+    auto &data = m_pending[fd];
+    uint32_t length = 0;
+    auto closed = false;
+
+    for (;;) {
+        size_t wanted = sizeof(length);
+        if (data.size() >= sizeof(length)) {
+            memcpy(&length, data.data(), sizeof(length));
+            length = ntohl(length);
+            if (length == 0 || length > MAX_NAME_LENGTH)
+                break;
+            wanted += length;
+        }
+        if (data.size() >= wanted)
+            break;
+
+        char buf[sizeof(length) + MAX_NAME_LENGTH];
+        const auto len = recv(fd, buf, wanted - data.size(), 0);
+        if (len > 0) {
+            data.append(buf, size_t(len));
+            continue;
+        }
+        if (len < 0 && errno == EINTR)
+            continue;
+        closed = len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+        break;
+    }
+
+    const auto refused = data.size() >= sizeof(length) && (length == 0 || length > MAX_NAME_LENGTH);
+    if (refused || (closed && data.size() < sizeof(length) + length)) {
+        berr("Failed to receive client name.");
+        m_pending.erase(fd);
+        close(fd);
+        return;
+    }
+
+    if (data.size() < sizeof(length) + length)
+        return; /* Rest of it is still on the way */
+
+    auto *name = static_cast<char *>(malloc(length)); /* Freed by io_client, like read_text() */
+    memcpy(name, data.data() + sizeof(length), length);
+    name[length - 1] = '\0';
+    m_pending.erase(fd);
+
+    auto *client = add_client(fd, name);
+    if (!client) {
+        free(name);
+        return;
+    }
+
+    /* Edge triggered, input sent right after the name won't be reported again */
+    receive(client);
+}
+
+void io_server::receive(io_client *client)
+{
+    /* Edge triggered, so everything has to be read now. Data goes straight into the
+     * client's receive buffer, each pass reads the complete frames and leaves room
+     * for the next recv(), so bursts of any size are read in one go */
+    auto received = false;
+    while (client->valid()) {
+        size_t space;
+        auto *dest = client->receive_space(space);
+        const auto len = recv(client->socket(), dest, space, 0);
+        if (len > 0) {
+            client->received(size_t(len));
+            received = true;
+            continue;
+        }
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            if (len < 0)
+                berr("Failed to receive buffer from %s. Closed connection", client->name());
+            client->mark_invalid();
+        }
+        break;
+    }
+
+    if (received)
+        client->publish_data();
+}
+
+int send_message(client_socket sock, message msg)
+{
+    const auto msg_id = uint8_t(msg);
+    const auto result = send(sock, &msg_id, sizeof(msg_id), MSG_NOSIGNAL);
+    if (result == sizeof(msg_id))
+        return int(result);
+
+    /* A full send buffer doesn't mean the client is gone, the message is dropped */
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return sizeof(msg_id);
+
+    berr("send failed: %s", strerror(errno));
+    return 0;
+}
+
+void close_socket(client_socket sock)
+{
+    if (sock >= 0)
+        close(sock);
+}
+}
@@ -0,0 +1,177 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/* Server loop on netlib, which works everywhere but can only check its socket
+ * set every LISTEN_TIMEOUT ms. Linux uses io_server_linux.cpp instead */
+
+#include "io_server.hpp"
+#include "remote_connection.hpp"
+#include <util/platform.h>
+
+#include "src/util/log.h"
+
+static netlib_socket_set sockets = nullptr;
+
+namespace network {
+io_server::~io_server()
+{
+    m_clients.clear();
+    if (sockets)
+        netlib_free_socket_set(sockets);
+    sockets = nullptr;
+    netlib_tcp_close(m_server);
+}
+
+bool io_server::init()
+{
+    auto flag = true;
+
+    if (netlib_resolve_host(&m_ip, nullptr, m_ip.port) == -1) {
+        berr("netlib_resolve_host failed: %s.", netlib_get_error());
+        flag = false;
+    } else {
+        const auto ipaddr = netlib_swap_BE32(m_ip.host);
+        berr("Remote connection open on %d.%d.%d.%d:%hu", ipaddr >> 24, ipaddr >> 16 & 0xff, ipaddr >> 8 & 0xff,
+             ipaddr & 0xff, m_ip.port);
+
+        m_server = netlib_tcp_open(&m_ip);
+        if (!m_server) {
+            berr("netlib_tcp_open failed: %s", netlib_get_error());
+            flag = false;
+        }
+    }
+    return flag;
+}
+
+void io_server::run()
+{
+    tcp_socket sock;
+
+    while (network_flag) {
+        int numready;
+        roundtrip();
+        listen(numready);
+
+        if (numready == -1) {
+            berr("netlib_check_sockets failed: %s", netlib_get_error());
+            break;
+        }
+
+        if (!numready) {
+            os_sleep_ms(LISTEN_TIMEOUT); /* Should be fast enough */
+            continue;
+        }
+
+        if (netlib_socket_ready(m_server)) {
+            numready--;
+            binfo("Received connection...");
+
+            sock = netlib_tcp_accept(m_server);
+
+            if (sock) {
+                char *name = nullptr;
+                binfo("Accepted connection...");
+
+                if (read_text(sock, &name)) {
+                    add_client(sock, name);
+                } else {
+                    berr("Failed to receive client name.");
+                    netlib_tcp_close(sock);
+                }
+            }
+        }
+
+        if (numready)
+            update_clients();
+    }
+}
+
+void io_server::wake()
+{
+    /* run() doesn't block for longer than LISTEN_TIMEOUT anyway */
+}
+
+void io_server::listen(int &numready)
+{
+    numready = create_sockets() ? netlib_check_socket_set(sockets, LISTEN_TIMEOUT) : -1;
+}
+
+void io_server::update_clients()
+{
+    /* The client list is only modified on this thread, so no lock is needed
+     * to iterate it. Input data is handed to the render thread through
+     * each client's snapshot, which never blocks either side */
+    for (const auto &client : m_clients) {
+        if (netlib_socket_ready(client->socket())) {
+            /* Receive input data, frames which aren't complete yet stay in the
+             * client's receive buffer until the rest arrives */
+            size_t space;
+            auto *dest = client->receive_space(space);
+            const int read = netlib_tcp_recv(client->socket(), dest, int(space));
+
+            if (read <= 0) {
+                berr("Failed to receive buffer from %s. Closed connection", client->name());
+                client->mark_invalid();
+                continue;
+            }
+
+            client->received(size_t(read));
+            client->publish_data();
+        }
+    }
+}
+
+bool io_server::create_sockets()
+{
+    if (sockets)
+        netlib_free_socket_set(sockets);
+
+    sockets = netlib_alloc_socket_set(m_num_clients + 1);
+    if (!sockets) {
+        berr("netlib_alloc_socket_set failed with %i clients.", m_num_clients + 1);
+        network_flag = false;
+        return false;
+    }
+
+    netlib_tcp_add_socket(sockets, m_server);
+
+    for (const auto &client : m_clients)
+        netlib_tcp_add_socket(sockets, client->socket());
+
+    return true;
+}
+
+int send_message(client_socket sock, message msg)
+{
+    auto msg_id = uint8_t(msg);
+
+    const uint32_t result = netlib_tcp_send(sock, &msg_id, sizeof(msg_id));
+
+    if (result < sizeof(msg_id)) {
+        berr("netlib_tcp_send: %s\n", netlib_get_error());
+        return 0;
+    }
+
+    return result;
+}
+
+void close_socket(client_socket sock)
+{
+    netlib_tcp_close(sock);
+}
+}
@@ -85,8 +85,12 @@ void close_network()
 {
     if (network_state) {
         network_flag = false;
-        network_thread.join();
+        if (network_thread.joinable()) {
+            server_instance->wake();
+            network_thread.join();
+        }
         delete server_instance;
+        server_instance = nullptr;
 
         netlib_quit();
     }
@@ -94,59 +98,7 @@ void close_network()
 
 void network_handler()
 {
-    tcp_socket sock;
-
-    while (network_flag) {
-        int numready;
-        server_instance->roundtrip();
-        server_instance->listen(numready);
-
-        if (numready == -1) {
-            berr("netlib_check_sockets failed: %s", netlib_get_error());
-            break;
-        }
-
-        if (!numready) {
-            os_sleep_ms(LISTEN_TIMEOUT); /* Should be fast enough */
-            continue;
-        }
-
-        if (netlib_socket_ready(server_instance->socket())) {
-            numready--;
-            binfo("Received connection...");
-
-            sock = netlib_tcp_accept(server_instance->socket());
-
-            if (sock) {
-                char *name = nullptr;
-                binfo("Accepted connection...");
-
-                if (read_text(sock, &name)) {
-                    server_instance->add_client(sock, name);
-                } else {
-                    berr("Failed to receive client name.");
-                    netlib_tcp_close(sock);
-                }
-            }
-        }
-
-        if (numready)
-            server_instance->update_clients();
-    }
-}
-
-int send_message(tcp_socket sock, message msg)
-{
-    auto msg_id = uint8_t(msg);
-
-    const uint32_t result = netlib_tcp_send(sock, &msg_id, sizeof(msg_id));
-
-    if (result < sizeof(msg_id)) {
-        berr("netlib_tcp_send: %s\n", netlib_get_error());
-        return 0;
-    }
-
-    return result;
+    server_instance->run();
 }
 
 /* https://www.libsdl.org/projects/SDL_net/docs/demos/tcputil.h */
@@ -181,13 +133,4 @@ char *read_text(tcp_socket sock, char **buf)
 
     return *buf;
 }
-
-message read_msg_from_buffer(buffer &buf)
-{
-    auto id = buf.read<uint8_t>();
-
-    if (id && *id <= MSG_LAST)
-        return message(*id);
-    return MSG_INVALID;
-}
 }
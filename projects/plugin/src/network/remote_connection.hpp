@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "io_client.hpp"
 #include "messages.hpp"
 #include <buffer.hpp>
 #include <netlib.h>
@@ -42,9 +43,10 @@ void network_handler();
 
 char *read_text(tcp_socket sock, char **buf);
 
-message read_msg_from_buffer(buffer &buf);
+/* Returns 0 if the connection is dead. Implemented by the platform's io_server */
+int send_message(client_socket sock, message msg);
 
-int send_message(tcp_socket sock, message msg);
+void close_socket(client_socket sock);
 
 extern io_server *server_instance;
 }
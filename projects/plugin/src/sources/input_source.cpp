@@ -17,6 +17,7 @@
  *************************************************************************/
 
 #include "input_source.hpp"
+#include "../hook/backends.hpp"
 #include "../hook/gamepad_hook_helper.hpp"
 #include "../util/lang.h"
 #include "../util/obs_util.hpp"
@@ -26,14 +27,47 @@
 #include "../network/remote_connection.hpp"
 #include <QFile>
 #include <QJsonDocument>
+#include <algorithm>
+#include <iolayout.h>
 #include <obs-frontend-api.h>
 
 namespace sources {
-input_source::~input_source() {}
+input_source::~input_source()
+{
+    backends::release(m_backends);
+}
+
+void input_source::update_backends()
+{
+    /* Replays and remote input don't need the local hooks, but remote
+     * input can still be combined with a local gamepad */
+    uint8_t wanted = 0;
+    if (m_visible && m_settings.mode == IM_LIVE && m_overlay->is_loaded()) {
+        wanted = m_overlay->backends();
+        if (m_settings.selected_source > 0)
+            wanted &= ~BACKEND_UIOHOOK;
+    }
+
+    /* Only updates the reference counts, the hooks are started and stopped elsewhere */
+    if (wanted == m_backends)
+        return;
+    backends::acquire(wanted & ~m_backends);
+    backends::release(m_backends & ~wanted);
+    m_backends = wanted;
+}
 
 inline void input_source::update(obs_data_t *settings)
 {
     m_settings.selected_source = obs_data_get_int(settings, S_INPUT_SOURCE);
+    m_settings.mode = obs_data_get_int(settings, S_INPUT_MODE);
+
+    /* The replay is kept around, so media controls never see it being destroyed */
+    const std::string replay_file = m_settings.mode == IM_REPLAY ? obs_data_get_string(settings, S_REPLAY_FILE) : "";
+    if (replay_file.empty())
+        m_settings.replay.close();
+    else if (m_settings.replay.path() != replay_file)
+        m_settings.replay.open(replay_file);
+    m_settings.replay.set_loop(obs_data_get_bool(settings, S_REPLAY_LOOP));
 
     const auto *config = obs_data_get_string(settings, S_LAYOUT_FILE);
     m_settings.image_file = obs_data_get_string(settings, S_OVERLAY_FILE);
@@ -41,7 +75,7 @@ inline void input_source::update(obs_data_t *settings)
     if (m_settings.layout_file != config) /* Only reload config file if path changed */
     {
         m_settings.layout_file = config;
-        m_overlay->load();
+        m_overlay->load_async();
     }
 
     libgamepad::hook_instance->get_mutex()->lock();
@@ -50,6 +84,7 @@ inline void input_source::update(obs_data_t *settings)
     libgamepad::hook_instance->get_mutex()->unlock();
 
     m_settings.mouse_sens = obs_data_get_int(settings, S_MOUSE_SENS);
+    m_settings.min_visible_ms = obs_data_get_int(settings, S_MIN_VISIBLE);
 
     if ((m_settings.use_center = obs_data_get_bool(settings, S_MONITOR_USE_CENTER))) {
         m_settings.monitor_h = obs_data_get_int(settings, S_MONITOR_H_CENTER);
@@ -61,6 +96,15 @@ inline void input_source::update(obs_data_t *settings)
 inline void input_source::tick(float seconds)
 {
     UNUSED_PARAMETER(seconds);
+    m_overlay->poll_load();
+    update_backends();
+
+    /* Hidden sources neither copy the input nor look for their gamepad. The
+     * first refresh after being shown again catches up in one go: snapshots
+     * copy the current state and replays step to the current position */
+    if (!m_visible)
+        return;
+
     if (m_overlay->is_loaded())
         m_overlay->refresh_data();
 
@@ -98,6 +142,18 @@ bool use_monitor_center_changed(obs_properties_t *props, obs_property_t *p, obs_
     return true;
 }
 
+bool input_mode_changed(obs_properties_t *props, obs_property_t *p, obs_data_t *data)
+{
+    UNUSED_PARAMETER(p);
+
+    const auto replay = obs_data_get_int(data, S_INPUT_MODE) == IM_REPLAY;
+    obs_property_set_visible(GET_PROPS(S_REPLAY_FILE), replay);
+    obs_property_set_visible(GET_PROPS(S_REPLAY_LOOP), replay);
+    if (GET_PROPS(S_INPUT_SOURCE))
+        obs_property_set_visible(GET_PROPS(S_INPUT_SOURCE), !replay);
+    return true;
+}
+
 bool reload_connections(obs_properties_t *props, obs_property_t *property, void *data)
 {
     UNUSED_PARAMETER(props);
@@ -129,6 +185,13 @@ obs_properties_t *get_properties_for_overlay(void *data)
     auto *const props = obs_properties_create();
     const int flags = src->m_settings.layout_flags;
 
+    /* Live input or a recording made with the record input option */
+    auto *mode =
+        obs_properties_add_list(props, S_INPUT_MODE, T_INPUT_MODE, OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(mode, T_INPUT_MODE_LIVE, IM_LIVE);
+    obs_property_list_add_int(mode, T_INPUT_MODE_REPLAY, IM_REPLAY);
+    obs_property_set_modified_callback(mode, input_mode_changed);
+
     /* If enabled add dropdown to select input source */
     if (CGET_BOOL(S_REMOTE)) {
         auto *list =
@@ -140,13 +203,19 @@ obs_properties_t *get_properties_for_overlay(void *data)
     }
 
     const auto filter_img = util_file_filter(T_FILTER_IMAGE_FILES, "*.jpg *.png *.bmp");
-    const auto filter_text = util_file_filter(T_FILTER_TEXT_FILES, "*.json");
+    const auto filter_text = util_file_filter(T_FILTER_LAYOUT_FILES, "*.json *." IO_LAYOUT_EXTENSION);
+    const auto filter_rec = util_file_filter(T_FILTER_RECORDING_FILES, "*." IO_REC_EXTENSION);
 
     /* Config and texture file path */
     obs_properties_add_path(props, S_OVERLAY_FILE, T_TEXTURE_FILE, OBS_PATH_FILE, qt_to_utf8(filter_img),
                             qt_to_utf8(img_path));
     obs_properties_add_path(props, S_LAYOUT_FILE, T_LAYOUT_FILE, OBS_PATH_FILE, qt_to_utf8(filter_text),
                             qt_to_utf8(layout_path));
+    obs_properties_add_path(props, S_REPLAY_FILE, T_REPLAY_FILE, OBS_PATH_FILE, qt_to_utf8(filter_rec), nullptr);
+    obs_properties_add_bool(props, S_REPLAY_LOOP, T_REPLAY_LOOP);
+
+    /* Short presses are latched for at least one frame, this extends that */
+    obs_properties_add_int_slider(props, S_MIN_VISIBLE, T_MIN_VISIBLE, 0, 500, 1);
 
     /* Mouse stuff */
     obs_properties_add_int_slider(props, S_MOUSE_SENS, T_MOUSE_SENS, 1, 500, 1);
@@ -178,13 +247,34 @@ obs_properties_t *get_properties_for_overlay(void *data)
     return props;
 }
 
+static input_replay &get_replay(void *data)
+{
+    return static_cast<input_source *>(data)->m_settings.replay;
+}
+
+static obs_media_state get_media_state(void *data)
+{
+    switch (get_replay(data).state()) {
+    case replay_state::playing:
+        return OBS_MEDIA_STATE_PLAYING;
+    case replay_state::paused:
+        return OBS_MEDIA_STATE_PAUSED;
+    case replay_state::stopped:
+        return OBS_MEDIA_STATE_STOPPED;
+    case replay_state::ended:
+        return OBS_MEDIA_STATE_ENDED;
+    default:
+        return OBS_MEDIA_STATE_NONE;
+    }
+}
+
 void register_overlay_source()
 {
     /* Input Overlay */
     obs_source_info si = {};
     si.id = "input-overlay";
     si.type = OBS_SOURCE_TYPE_INPUT;
-    si.output_flags = OBS_SOURCE_VIDEO;
+    si.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CONTROLLABLE_MEDIA;
     si.get_properties = get_properties_for_overlay;
 
     si.get_name = [](void *) { return obs_module_text("InputOverlay"); };
@@ -198,6 +288,19 @@ void register_overlay_source()
     si.update = [](void *data, obs_data_t *settings) { static_cast<input_source *>(data)->update(settings); };
     si.video_tick = [](void *data, float seconds) { static_cast<input_source *>(data)->tick(seconds); };
     si.video_render = [](void *data, gs_effect_t *effect) { static_cast<input_source *>(data)->render(effect); };
+    si.show = [](void *data) { static_cast<input_source *>(data)->m_visible = true; };
+    si.hide = [](void *data) { static_cast<input_source *>(data)->m_visible = false; };
+
+    /* Media controls are used to scrub through replays */
+    si.media_play_pause = [](void *data, bool pause) { get_replay(data).set_paused(pause); };
+    si.media_restart = [](void *data) { get_replay(data).restart(); };
+    si.media_stop = [](void *data) { get_replay(data).stop(); };
+    si.media_get_duration = [](void *data) { return int64_t(get_replay(data).duration() / 1000000); };
+    si.media_get_time = [](void *data) { return int64_t(get_replay(data).position() / 1000000); };
+    si.media_set_time = [](void *data, int64_t ms) {
+        get_replay(data).seek(uint64_t(std::max<int64_t>(ms, 0)) * 1000000);
+    };
+    si.media_get_state = get_media_state;
     obs_register_source(&si);
 }
 }
@@ -19,7 +19,9 @@
 #pragma once
 
 #include "../util/overlay.hpp"
-#include "../util/input_data.hpp"
+#include "../util/input_snapshot.hpp"
+#include "../util/input_recording.hpp"
+#include <atomic>
 #include <obs-module.h>
 #include <string>
 
@@ -30,26 +32,34 @@ extern "C" {
 typedef struct obs_data obs_data_t;
 
 namespace sources {
+enum input_mode { IM_LIVE, IM_REPLAY };
+
 class overlay_settings {
 public:
     /* clang-format: off */
     std::string image_file;
     std::string layout_file;
 
-    input_data data{};                        /* Copy of input data used for visualization          */
+    std::shared_ptr<input_snapshot> input;    /* Shared copy of the selected input, see refresh_data*/
+    const input_data *data = nullptr;         /* Input data used for visualization, never null      */
     uint32_t cx = 0, cy = 0;                  /* Source width/height                                */
     bool use_center = false;                  /* true if monitor center is used for mouse movement	*/
     uint32_t monitor_w = 0, monitor_h = 0;    /* Monitor size used for mouse movement               */
     uint8_t mouse_deadzone = 0;               /* Region in which to ignore mouse movements          */
     uint16_t mouse_sens = 0;                  /* mouse_delta / mouse_sens = mouse movement			*/
+    uint16_t min_visible_ms = 0;              /* Minimum time a button press stays visible          */
     std::shared_ptr<gamepad::device> gamepad; /* selected gamepad                                   */
+    input_replay replay;                      /* Replaces the live input in replay mode             */
 
     uint8_t selected_source = 0;      /* 0 = Local input, 0< remote computers                 */
+    uint8_t mode = IM_LIVE;           /* See input_mode                                       */
     uint8_t layout_flags = 0;         /* See overlay_flags in layout_constants.hpp            */
     obs_data_t *source = nullptr;     /* Pointer to source property data                      */
     float gamepad_check_timer = 0.0f; /* Counter to check if selected game pad is connected   */
     std::string gamepad_id;
     /* clang-format: on */
+
+    overlay_settings() : data(&input_snapshot::empty) {}
 };
 
 class input_source {
@@ -59,6 +69,10 @@ public:
     uint32_t cx = 0, cy = 0;
     std::unique_ptr<overlay> m_overlay{};
     overlay_settings m_settings;
+    /* Shown in the program, preview or a projector. OBS calls show() for every
+     * active source as well, so this covers activate() too */
+    std::atomic<bool> m_visible{false};
+    uint8_t m_backends = 0; /* Backends this source holds a reference on, see backends.hpp */
 
     input_source(obs_source_t *source, obs_data_t *settings) : m_source(source)
     {
@@ -73,12 +87,17 @@ public:
 
     inline void tick(float seconds);
 
+    /* Holds on to the backends the source currently needs, video thread only */
+    void update_backends();
+
     inline void render(gs_effect_t *effect) const;
 };
 
 /* Event handlers */
 static bool use_monitor_center_changed(obs_properties_t *props, obs_property_t *p, obs_data_t *data);
 
+static bool input_mode_changed(obs_properties_t *props, obs_property_t *p, obs_data_t *data);
+
 static bool reload_connections(obs_properties_t *props, obs_property_t *property, void *data);
 
 /* For registering */
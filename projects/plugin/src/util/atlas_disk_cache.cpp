@@ -0,0 +1,152 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "atlas_disk_cache.hpp"
+#include "config.hpp"
+#include "log.h"
+#include "mapped_file.hpp"
+#include "obs_util.hpp"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <cstdio>
+#include <string.h>
+#include <util/bmem.h>
+extern "C" {
+#include <graphics/image-file.h>
+}
+
+#define ATLAS_CACHE_HASH_BASIS 0xcbf29ce484222325ull /* FNV-1a */
+#define ATLAS_CACHE_HASH_PRIME 0x100000001b3ull
+
+namespace atlas_disk_cache {
+static uint64_t hash_file(const std::string &path)
+{
+    mapped_file file;
+    if (!file.open(path.c_str()))
+        return 0;
+
+    auto hash = ATLAS_CACHE_HASH_BASIS;
+    const auto *data = file.data();
+    for (size_t i = 0; i < file.size(); i++)
+        hash = (hash ^ data[i]) * ATLAS_CACHE_HASH_PRIME;
+    return hash;
+}
+
+static QString entry_path(const uint64_t hash)
+{
+    const auto dir = util_get_data_file(ATLAS_CACHE_DIR);
+    QDir().mkpath(dir);
+    return QDir(dir).filePath(QString("%1." ATLAS_CACHE_EXTENSION).arg(hash, 16, 16, QChar('0')));
+}
+
+static uint64_t pixel_size(const atlas_cache_header &header)
+{
+    return uint64_t(header.cx) * header.cy * 4;
+}
+
+bool load(const std::string &path, uint64_t &hash, gs_image_file_t *image)
+{
+    hash = 0;
+    /* Animated gifs are decoded frame by frame */
+    if (!io_config::atlas_cache || utf8_to_qt(path.c_str()).endsWith(".gif", Qt::CaseInsensitive))
+        return false;
+
+    hash = hash_file(path);
+    if (!hash)
+        return false;
+
+    const auto cached = entry_path(hash);
+    mapped_file file;
+    if (!file.open(qt_to_utf8(cached)))
+        return false;
+
+    atlas_cache_header header;
+    if (file.size() < sizeof(header))
+        return false;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, ATLAS_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != ATLAS_CACHE_VERSION || file.size() < sizeof(header) + pixel_size(header)) {
+        QFile::remove(cached);
+        return false;
+    }
+
+    image->cx = header.cx;
+    image->cy = header.cy;
+    image->format = static_cast<gs_color_format>(header.format);
+    image->texture_data = static_cast<uint8_t *>(bmemdup(file.data() + sizeof(header), pixel_size(header)));
+    image->loaded = true;
+
+    /* Modification time is used as the last use for eviction */
+    QFile touch(cached);
+    if (touch.open(QIODevice::Append))
+        touch.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+static void evict(const QString &dir)
+{
+    const auto limit = uint64_t(io_config::atlas_cache_size) * 1024 * 1024;
+    const auto entries =
+        QDir(dir).entryInfoList(QStringList("*." ATLAS_CACHE_EXTENSION), QDir::Files, QDir::Time); /* Newest first */
+    uint64_t total = 0;
+    for (const auto &entry : entries) {
+        total += uint64_t(entry.size());
+        if (total > limit && QFile::remove(entry.absoluteFilePath()))
+            binfo("Removed %s from the image cache", qt_to_utf8(entry.fileName()));
+    }
+}
+
+void store(const uint64_t hash, const gs_image_file_t *image)
+{
+    /* Only plain 32 bit images, which is what decoding png/jpg/bmp results in */
+    if (!hash || !image->loaded || !image->texture_data || (image->format != GS_RGBA && image->format != GS_BGRA))
+        return;
+
+    atlas_cache_header header{};
+    memcpy(header.magic, ATLAS_CACHE_MAGIC, sizeof(header.magic));
+    header.version = ATLAS_CACHE_VERSION;
+    header.format = uint16_t(image->format);
+    header.cx = image->cx;
+    header.cy = image->cy;
+
+    /* QSaveFile writes to a temporary file of its own and renames it when
+     * committed, so a crash never leaves a broken entry behind and two loader
+     * threads storing the same image can't write into each other's file */
+    const auto cached = entry_path(hash);
+    QSaveFile file(cached);
+    if (!file.open(QIODevice::WriteOnly)) {
+        bwarn("Couldn't write %s to the image cache", qt_to_utf8(cached));
+        return;
+    }
+
+    const auto ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header) &&
+                    file.write(reinterpret_cast<const char *>(image->texture_data), pixel_size(header)) ==
+                        qint64(pixel_size(header));
+    if (!ok) {
+        file.cancelWriting();
+        return;
+    }
+    if (!file.commit()) {
+        bwarn("Couldn't write %s to the image cache", qt_to_utf8(cached));
+        return;
+    }
+    evict(QFileInfo(cached).absolutePath());
+}
+}
@@ -0,0 +1,49 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+typedef struct gs_image_file gs_image_file_t;
+
+/* Decoded images are kept in the plugin config folder, so the next time OBS
+ * loads them they're copied instead of decoded. Entries are keyed by a hash of
+ * the image file's content, the least recently used ones are deleted once the
+ * cache is larger than io_config::atlas_cache_size */
+#define ATLAS_CACHE_MAGIC "IOAC"
+#define ATLAS_CACHE_VERSION 1
+#define ATLAS_CACHE_DIR "atlas-cache"
+#define ATLAS_CACHE_EXTENSION "rgba"
+
+struct atlas_cache_header {
+    char magic[4];
+    uint16_t version;
+    uint16_t format; /* gs_color_format of the pixels */
+    uint32_t cx, cy;
+};
+
+namespace atlas_disk_cache {
+/* Fills in an image which isn't uploaded yet from the cache. hash is set to the
+ * content hash of the file, which store() needs, or 0 if the cache is disabled */
+bool load(const std::string &path, uint64_t &hash, gs_image_file_t *image);
+
+/* Writes the pixels of a decoded image which isn't uploaded yet */
+void store(uint64_t hash, const gs_image_file_t *image);
+}
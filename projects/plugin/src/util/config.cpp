@@ -36,6 +36,9 @@ bool overlay = true;
 bool regex = false;
 bool log_flag = false;
 int filter_mode = 0;
+bool record_input = false;
+bool atlas_cache = true;
+uint32_t atlas_cache_size = 256;
 uint16_t refresh_rate = 250;
 uint16_t port = 1608;
 
@@ -45,6 +48,9 @@ void set_defaults()
     CDEF_BOOL(S_UIOHOOK, io_config::uiohook);
     CDEF_BOOL(S_GAMEPAD, io_config::gamepad);
     CDEF_BOOL(S_OVERLAY, io_config::overlay);
+    CDEF_BOOL(S_RECORD_INPUT, io_config::record_input);
+    CDEF_BOOL(S_ATLAS_CACHE, io_config::atlas_cache);
+    CDEF_UINT(S_ATLAS_CACHE_SIZE, io_config::atlas_cache_size);
 
     CDEF_BOOL(S_REMOTE, io_config::remote);
     CDEF_BOOL(S_LOGGING, io_config::log_flag);
@@ -64,6 +70,9 @@ void load()
     io_config::remote = CGET_BOOL(S_REMOTE);
     io_config::control = CGET_BOOL(S_CONTROL);
     io_config::filter_mode = CGET_INT(S_FILTER_MODE);
+    io_config::record_input = CGET_BOOL(S_RECORD_INPUT);
+    io_config::atlas_cache = CGET_BOOL(S_ATLAS_CACHE);
+    io_config::atlas_cache_size = uint32_t(CGET_UINT(S_ATLAS_CACHE_SIZE));
 
     io_config::port = CGET_INT(S_PORT);
     io_config::log_flag = CGET_BOOL(S_LOGGING);
@@ -78,6 +87,9 @@ void save()
     CSET_BOOL(S_REMOTE, io_config::remote);
     CSET_BOOL(S_CONTROL, io_config::control);
     CSET_BOOL(S_OVERLAY, io_config::overlay);
+    CSET_BOOL(S_RECORD_INPUT, io_config::record_input);
+    CSET_BOOL(S_ATLAS_CACHE, io_config::atlas_cache);
+    CSET_UINT(S_ATLAS_CACHE_SIZE, io_config::atlas_cache_size);
     CSET_INT(S_PORT, io_config::port);
     CSET_INT(S_REFRESH, io_config::refresh_rate);
     CSET_BOOL(S_LOGGING, io_config::log_flag);
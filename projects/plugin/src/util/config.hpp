@@ -53,6 +53,9 @@ extern bool uiohook;
 extern bool overlay;
 extern bool regex;
 extern int filter_mode;
+extern bool record_input;
+extern bool atlas_cache;
+extern uint32_t atlas_cache_size; /* In MiB */
 /* Netowork config */
 extern bool log_flag;
 extern uint16_t refresh_rate;
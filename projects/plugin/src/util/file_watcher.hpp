@@ -0,0 +1,41 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+/* How often the watcher thread checks whether it should stop (and, on
+ * platforms without change notifications, how often files are checked) */
+#define FILE_WATCHER_INTERVAL_MS 250
+
+/* Notices changes to layout and image files while they're in use, so edits
+ * show up without touching the source. Platform specific, see
+ * file_watcher_nix.cpp (inotify) and file_watcher_win.cpp (polling) */
+namespace file_watcher {
+/* Starts watching a file, calls are counted so every watch() needs an unwatch() */
+void watch(const std::string &path);
+
+void unwatch(const std::string &path);
+
+/* Increased whenever a watched file was written, cheap enough to check every frame */
+uint32_t changes();
+
+void stop();
+}
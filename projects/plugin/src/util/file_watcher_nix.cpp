@@ -0,0 +1,178 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "file_watcher.hpp"
+#include "log.h"
+#include "obs_util.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <thread>
+#include <unistd.h>
+
+namespace file_watcher {
+/* Directories are watched instead of the files, since most editors save
+ * by writing a new file and renaming it over the old one */
+struct directory {
+    int wd;
+    int files;
+};
+
+struct file {
+    std::string canonical; /* Resolved once, the file might be gone when it's unwatched */
+    std::string directory;
+    int count;
+};
+
+static std::mutex mutex;
+static std::map<std::string, file> files; /* Path as passed to watch() */
+static std::map<std::string, directory> directories;
+static std::atomic<uint32_t> change_count{0};
+static std::atomic<bool> running{false};
+static std::thread watcher;
+static int fd = -1;
+
+static std::string parent_directory(const std::string &path)
+{
+    const auto slash = path.find_last_of('/');
+    return slash == std::string::npos ? "." : path.substr(0, slash);
+}
+
+static void watcher_loop()
+{
+    alignas(struct inotify_event) char buf[4096];
+    pollfd pfd = {fd, POLLIN, 0};
+
+    while (running) {
+        if (poll(&pfd, 1, FILE_WATCHER_INTERVAL_MS) <= 0)
+            continue;
+
+        const auto len = read(fd, buf, sizeof(buf));
+        if (len <= 0)
+            continue;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto changed = false;
+        for (auto *ptr = buf; ptr < buf + len;) {
+            const auto *event = reinterpret_cast<const struct inotify_event *>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+            if (!event->len)
+                continue;
+
+            for (const auto &f : files) {
+                const auto &dir = directories.find(f.second.directory);
+                if (dir != directories.end() && dir->second.wd == event->wd &&
+                    f.second.canonical.compare(f.second.directory.size() + 1, std::string::npos, event->name) == 0) {
+                    changed = true;
+                    break;
+                }
+            }
+        }
+
+        if (changed)
+            change_count++;
+    }
+}
+
+/* Expects the lock to be held */
+static bool start()
+{
+    if (running)
+        return true;
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        bwarn("Couldn't start file watcher, layout and image changes won't be reloaded");
+        return false;
+    }
+
+    running = true;
+    watcher = std::thread(watcher_loop);
+    return true;
+}
+
+void watch(const std::string &path)
+{
+    if (path.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!start())
+        return;
+
+    auto &f = files[path];
+    if (f.count++ > 0)
+        return;
+
+    int64_t mtime;
+    util_file_version(path, f.canonical, mtime);
+    f.directory = parent_directory(f.canonical);
+    const auto &dir = f.directory;
+
+    auto it = directories.find(dir);
+    if (it == directories.end()) {
+        const auto wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            bwarn("Couldn't watch %s for changes", dir.c_str());
+            return;
+        }
+        it = directories.emplace(dir, directory{wd, 0}).first;
+    }
+    it->second.files++;
+}
+
+void unwatch(const std::string &path)
+{
+    if (path.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto f = files.find(path);
+    if (f == files.end() || --f->second.count > 0)
+        return;
+
+    auto it = directories.find(f->second.directory);
+    files.erase(f);
+    if (it != directories.end() && --it->second.files <= 0) {
+        inotify_rm_watch(fd, it->second.wd);
+        directories.erase(it);
+    }
+}
+
+uint32_t changes()
+{
+    return change_count.load(std::memory_order_relaxed);
+}
+
+void stop()
+{
+    if (!running)
+        return;
+
+    running = false;
+    watcher.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    close(fd);
+    fd = -1;
+    files.clear();
+    directories.clear();
+}
+}
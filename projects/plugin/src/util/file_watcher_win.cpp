@@ -0,0 +1,103 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "file_watcher.hpp"
+#include "obs_util.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <util/platform.h>
+
+/* Watched files are few and small, so checking their modification time
+ * is simpler than keeping a change notification handle per directory */
+namespace file_watcher {
+struct file {
+    int64_t mtime;
+    int count;
+};
+
+static std::mutex mutex;
+static std::map<std::string, file> files; /* Path as passed to watch() */
+static std::atomic<uint32_t> change_count{0};
+static std::atomic<bool> running{false};
+static std::thread watcher;
+
+static void watcher_loop()
+{
+    while (running) {
+        os_sleep_ms(FILE_WATCHER_INTERVAL_MS);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto changed = false;
+        for (auto &f : files) {
+            std::string key;
+            int64_t mtime;
+            util_file_version(f.first, key, mtime);
+            if (mtime != f.second.mtime) {
+                f.second.mtime = mtime;
+                changed = true;
+            }
+        }
+
+        if (changed)
+            change_count++;
+    }
+}
+
+void watch(const std::string &path)
+{
+    if (path.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+        running = true;
+        watcher = std::thread(watcher_loop);
+    }
+
+    auto &f = files[path];
+    if (f.count++ == 0) {
+        std::string key;
+        util_file_version(path, key, f.mtime);
+    }
+}
+
+void unwatch(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto f = files.find(path);
+    if (f != files.end() && --f->second.count <= 0)
+        files.erase(f);
+}
+
+uint32_t changes()
+{
+    return change_count.load(std::memory_order_relaxed);
+}
+
+void stop()
+{
+    if (!running)
+        return;
+
+    running = false;
+    watcher.join();
+    files.clear();
+}
+}
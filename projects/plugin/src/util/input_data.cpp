@@ -17,41 +17,88 @@
  *************************************************************************/
 
 #include "input_data.hpp"
+#include <util.hpp>
 
 namespace local_data {
-std::mutex data_mutex;
 input_data data;
+triple_buffer<input_data> snapshot;
+spsc_queue<input_press, IO_PRESS_QUEUE_SIZE> presses;
+}
+
+void input_latch::add(const input_press &press)
+{
+    if (input_data::is_mouse_code(press.code)) {
+        if ((press.code & 0xff) < IO_MOUSE_BUTTON_COUNT)
+            mouse.set(press.code & 0xff);
+    } else {
+        const auto idx = input_data::key_index(press.code);
+        if (idx != IO_KEY_INVALID)
+            keyboard.set(idx);
+    }
+}
+
+uint16_t input_data::press_code(const uiohook_event *event)
+{
+    switch (event->type) {
+    case EVENT_KEY_PRESSED:
+        return event->data.keyboard.keycode;
+    case EVENT_MOUSE_PRESSED:
+        return common::util_mouse_to_vc(event->data.mouse.button);
+    default:
+        return VC_NONE;
+    }
 }
 
 void input_data::copy(const input_data *other)
 {
-    keyboard = other->keyboard;
-    mouse = other->mouse;
-    gamepad_buttons = other->gamepad_buttons;
-    gamepad_axis = other->gamepad_axis;
-    last_key_pressed = other->last_key_pressed;
-    last_key_released = other->last_key_released;
-    last_key_typed = other->last_key_typed;
-    last_mouse_pressed = other->last_mouse_pressed;
-    last_mouse_dragged = other->last_mouse_dragged;
-    last_mouse_movement = other->last_mouse_movement;
-    last_mouse_pressed = other->last_mouse_pressed;
-    last_mouse_released = other->last_mouse_released;
-    last_axis_event = other->last_axis_event;
-    last_button_event = other->last_button_event;
+    /* All members are flat, so this is a plain memberwise copy */
+    *this = *other;
+}
+
+void input_data::copy_gamepad(const std::shared_ptr<gamepad::device> &pad)
+{
+    gamepad_buttons.reset();
+    gamepad_axis.fill(0.f);
+
+    for (const auto &button : pad->get_buttons()) {
+        if (button.first < IO_PAD_BUTTON_COUNT)
+            gamepad_buttons.set(button.first, button.second);
+    }
+
+    for (const auto &axis : pad->get_axis()) {
+        if (axis.first < IO_PAD_AXIS_COUNT)
+            gamepad_axis[axis.first] = axis.second;
+    }
+
+    last_axis_event = *pad->last_axis_event();
+    last_button_event = *pad->last_button_event();
+}
+
+void input_data::set_key_state(const uint16_t keycode, const bool state)
+{
+    const auto idx = key_index(keycode);
+    if (idx != IO_KEY_INVALID)
+        keyboard.set(idx, state);
+}
+
+void input_data::set_mouse_state(const uint16_t button, const bool state)
+{
+    /* Stored the same way layouts refer to them (VC_MOUSE_BUTTON*) */
+    const auto idx = common::util_mouse_to_vc(button) & 0xff;
+    if (idx < IO_MOUSE_BUTTON_COUNT)
+        mouse.set(idx, state);
 }
 
 void input_data::dispatch_uiohook_event(const uiohook_event *event)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
     switch (event->type) {
     case EVENT_KEY_PRESSED:
         last_key_pressed = event->data.keyboard;
-        keyboard[event->data.keyboard.keycode] = true;
+        set_key_state(event->data.keyboard.keycode, true);
         break;
     case EVENT_KEY_RELEASED:
         last_key_released = event->data.keyboard;
-        keyboard[event->data.keyboard.keycode] = false;
+        set_key_state(event->data.keyboard.keycode, false);
         break;
     case EVENT_KEY_TYPED:
         last_key_typed = event->data.keyboard;
@@ -61,11 +108,11 @@ void input_data::dispatch_uiohook_event(const uiohook_event *event)
         break;
     case EVENT_MOUSE_PRESSED:
         last_mouse_pressed = event->data.mouse;
-        mouse[event->data.mouse.button] = true;
+        set_mouse_state(event->data.mouse.button, true);
         break;
     case EVENT_MOUSE_RELEASED:
         last_mouse_released = event->data.mouse;
-        mouse[event->data.mouse.button] = false;
+        set_mouse_state(event->data.mouse.button, false);
         break;
     case EVENT_MOUSE_CLICKED:
         last_mouse_clicked = event->data.mouse;
@@ -18,19 +18,40 @@
 
 #pragma once
 
-#include <map>
-#include <mutex>
+#include "triple_buffer.hpp"
+#include "spsc_queue.hpp"
+#include <array>
+#include <bitset>
 #include <uiohook.h>
 #include <libgamepad.hpp>
+#include <keycodes.h>
 
-/* Holds all input data for a computer, local or remote */
+/* uiohook key codes are spread over a few 256 wide pages
+ * (0x00xx, 0x0Exx, 0xE0xx, 0xEExx, 0xFFxx), which are remapped
+ * into one dense index range, see input_data::key_index */
+#define IO_KEY_PAGE_SIZE 0x100
+#define IO_KEY_PAGES 5
+#define IO_KEY_COUNT (IO_KEY_PAGE_SIZE * IO_KEY_PAGES)
+#define IO_KEY_INVALID 0xFFFFu
+
+#define IO_MOUSE_BUTTON_COUNT 8
+#define IO_PAD_BUTTON_COUNT 32
+#define IO_PAD_AXIS_COUNT 16
+
+/* Pending presses between two frames, at 1000 events/s this is plenty */
+#define IO_PRESS_QUEUE_SIZE 256
+/* Presses older than this are stale when drained (e.g. no source read them) */
+#define IO_PRESS_MAX_AGE_NS (100 * 1000 * 1000)
+
+/* Holds all input data for a computer, local or remote.
+ * Each instance has exactly one writer thread, other threads only
+ * see published copies (see triple_buffer) */
 struct input_data {
-    std::mutex m_mutex;
-    /* State of all keyboard keys*/
-    std::map<uint16_t, bool> keyboard{};
+    /* State of all keyboard keys, indexed by key_index() */
+    std::bitset<IO_KEY_COUNT> keyboard{};
 
-    /* State of all mouse buttons */
-    std::map<uint16_t, bool> mouse{};
+    /* State of all mouse buttons, indexed by the low byte of their VC_MOUSE_* code */
+    std::bitset<IO_MOUSE_BUTTON_COUNT> mouse{};
 
     /* Last uiohook events */
     keyboard_event_data last_key_pressed{}, last_key_released{}, last_key_typed{};
@@ -38,19 +59,114 @@ struct input_data {
         last_mouse_dragged{};
     mouse_wheel_event_data last_wheel_event{};
 
-    /* Gamepad data */
-    std::map<uint16_t, float> gamepad_axis{};
-    std::map<uint16_t, bool> gamepad_buttons{};
+    /* Gamepad data, indexed by libgamepad button/axis ids */
+    std::array<float, IO_PAD_AXIS_COUNT> gamepad_axis{};
+    std::bitset<IO_PAD_BUTTON_COUNT> gamepad_buttons{};
     gamepad::input_event last_axis_event{};
     gamepad::input_event last_button_event{};
 
-    /* Mutex needs to be locked */
+    /* os_gettime_ns() when the writer thread received the newest event,
+     * used to measure the latency until it is rendered (see latency.hpp) */
+    uint64_t event_time = 0;
+
+    /* Maps a uiohook key code to its bit in the keyboard table
+     * or IO_KEY_INVALID if the code doesn't belong to a known page */
+    static inline uint16_t key_index(uint16_t keycode)
+    {
+        const uint16_t low = keycode & 0xff;
+        switch (keycode >> 8) {
+        case 0x00:
+            return low;
+        case 0x0E:
+            return IO_KEY_PAGE_SIZE * 1 + low;
+        case 0xE0:
+            return IO_KEY_PAGE_SIZE * 2 + low;
+        case 0xEE:
+            return IO_KEY_PAGE_SIZE * 3 + low;
+        case 0xFF:
+            return IO_KEY_PAGE_SIZE * 4 + low;
+        default:
+            return IO_KEY_INVALID;
+        }
+    }
+
+    static inline bool is_mouse_code(uint16_t keycode) { return (keycode & 0xff00) == VC_MOUSE_MASK; }
+
+    /* Key code of a press event as queued in local_data::presses, VC_NONE otherwise */
+    static uint16_t press_code(const uiohook_event *event);
+
+    inline bool key_state(uint16_t keycode) const
+    {
+        const auto idx = key_index(keycode);
+        return idx != IO_KEY_INVALID && keyboard.test(idx);
+    }
+
+    /* Takes VC_MOUSE_* codes */
+    inline bool mouse_state(uint16_t keycode) const
+    {
+        return is_mouse_code(keycode) && (keycode & 0xff) < IO_MOUSE_BUTTON_COUNT && mouse.test(keycode & 0xff);
+    }
+
+    inline bool gamepad_button_state(uint16_t button) const
+    {
+        return button < IO_PAD_BUTTON_COUNT && gamepad_buttons.test(button);
+    }
+
+    inline float gamepad_axis_state(uint16_t axis) const
+    {
+        return axis < IO_PAD_AXIS_COUNT ? gamepad_axis[axis] : 0.f;
+    }
+
+    /* Pressed state of any button type, used by button elements
+     * which don't know whether their code is a key, mouse or gamepad button */
+    inline bool button_state(uint16_t keycode) const
+    {
+        return gamepad_button_state(keycode) || key_state(keycode) || mouse_state(keycode);
+    }
+
     void copy(const input_data *other);
 
+    /* Copies the current gamepad state, hook mutex needs to be locked */
+    void copy_gamepad(const std::shared_ptr<gamepad::device> &pad);
+
     void dispatch_uiohook_event(const uiohook_event *event);
+
+private:
+    void set_key_state(uint16_t keycode, bool state);
+    void set_mouse_state(uint16_t button, bool state);
+};
+
+/* A key or mouse button press, queued by the hook thread so presses
+ * which are released again before the next frame still show up */
+struct input_press {
+    uint64_t time; /* os_gettime_ns() at hook time */
+    uint16_t code; /* uiohook key code or VC_MOUSE_* */
+};
+
+/* Keys and buttons pressed at any point since the last frame */
+struct input_latch {
+    std::bitset<IO_KEY_COUNT> keyboard{};
+    std::bitset<IO_MOUSE_BUTTON_COUNT> mouse{};
+
+    void clear()
+    {
+        keyboard.reset();
+        mouse.reset();
+    }
+
+    void add(const input_press &press);
+
+    /* Makes latched presses visible in data for this frame */
+    void apply(input_data &data) const
+    {
+        data.keyboard |= keyboard;
+        data.mouse |= mouse;
+    }
 };
 
 namespace local_data {
-extern std::mutex data_mutex;
-extern input_data data;
+extern input_data data;                    /* Only written to by the uiohook thread */
+extern triple_buffer<input_data> snapshot; /* Latest published copy of data */
+/* Presses from the uiohook thread, drained once per frame by the video thread */
+extern spsc_queue<input_press, IO_PRESS_QUEUE_SIZE> presses;
 }
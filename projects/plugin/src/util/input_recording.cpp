@@ -0,0 +1,507 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "input_recording.hpp"
+#include "log.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <util.hpp>
+#include <util/platform.h>
+#include <vector>
+
+io_record io_record::from_event(const uiohook_event *event, const uint64_t time)
+{
+    io_record r{};
+    r.time = time;
+    r.type = uint8_t(event->type);
+
+    switch (event->type) {
+    case EVENT_KEY_PRESSED:
+    case EVENT_KEY_RELEASED:
+    case EVENT_KEY_TYPED:
+        r.code = event->data.keyboard.keycode;
+        r.a = event->data.keyboard.rawcode;
+        r.b = event->data.keyboard.keychar;
+        break;
+    case EVENT_MOUSE_WHEEL:
+        r.code = event->data.wheel.amount;
+        r.a = event->data.wheel.clicks;
+        r.b = uint16_t(event->data.wheel.rotation);
+        r.x = event->data.wheel.x;
+        r.y = event->data.wheel.y;
+        r.aux = uint8_t((event->data.wheel.type & 0xf) | (event->data.wheel.direction << 4));
+        break;
+    default: /* All other events are mouse events */
+        r.code = event->data.mouse.button;
+        r.a = event->data.mouse.clicks;
+        r.x = event->data.mouse.x;
+        r.y = event->data.mouse.y;
+    }
+    return r;
+}
+
+io_record io_record::from_pad_event(const gamepad::input_event *event, const bool axis, const uint8_t device,
+                                    const uint64_t time)
+{
+    io_record r{};
+    r.time = time;
+    r.type = axis ? IO_REC_PAD_AXIS : IO_REC_PAD_BUTTON;
+    r.aux = device;
+    r.code = event->vc;
+    r.a = event->native_id;
+    r.x = int16_t(event->value & 0xffff);
+    r.y = int16_t(event->value >> 16);
+    r.value = event->virtual_value;
+    return r;
+}
+
+io_record io_record::state(const io_record_type type, const uint16_t index, const float value, const uint64_t time)
+{
+    io_record r{};
+    r.time = time;
+    r.type = type;
+    r.code = index;
+    r.value = value;
+    return r;
+}
+
+uint16_t io_record::press_code() const
+{
+    switch (type) {
+    case EVENT_KEY_PRESSED:
+        return code;
+    case EVENT_MOUSE_PRESSED:
+        return common::util_mouse_to_vc(code);
+    default:
+        return VC_NONE;
+    }
+}
+
+void io_record::apply(input_data &data) const
+{
+    switch (type) {
+    case IO_REC_PAD_BUTTON:
+    case IO_REC_PAD_AXIS: {
+        gamepad::input_event event;
+        event.native_id = a;
+        event.vc = code;
+        event.value = int32_t(uint16_t(x)) | int32_t(uint32_t(uint16_t(y)) << 16);
+        event.virtual_value = value;
+        event.time = time;
+
+        if (type == IO_REC_PAD_BUTTON) {
+            if (code < IO_PAD_BUTTON_COUNT)
+                data.gamepad_buttons.set(code, value > .5f);
+            data.last_button_event = event;
+        } else {
+            if (code < IO_PAD_AXIS_COUNT)
+                data.gamepad_axis[code] = value;
+            data.last_axis_event = event;
+        }
+        break;
+    }
+    case IO_REC_KEYFRAME:
+        data = input_data{};
+        break;
+    case IO_REC_STATE_KEY:
+        if (code < IO_KEY_COUNT)
+            data.keyboard.set(code);
+        break;
+    case IO_REC_STATE_MOUSE:
+        if (code < IO_MOUSE_BUTTON_COUNT)
+            data.mouse.set(code);
+        break;
+    case IO_REC_STATE_PAD_BUTTON:
+        if (code < IO_PAD_BUTTON_COUNT)
+            data.gamepad_buttons.set(code);
+        break;
+    case IO_REC_STATE_PAD_AXIS:
+        if (code < IO_PAD_AXIS_COUNT)
+            data.gamepad_axis[code] = value;
+        break;
+    default: {
+        /* Goes through the same path as live uiohook events */
+        uiohook_event event;
+        if (to_event(event))
+            data.dispatch_uiohook_event(&event);
+    }
+    }
+}
+
+bool io_record::to_event(uiohook_event &event) const
+{
+    if (type >= IO_REC_PAD_BUTTON)
+        return false;
+
+    event = {};
+    event.type = event_type(type);
+    event.time = time;
+
+    switch (type) {
+    case EVENT_KEY_PRESSED:
+    case EVENT_KEY_RELEASED:
+    case EVENT_KEY_TYPED:
+        event.data.keyboard.keycode = code;
+        event.data.keyboard.rawcode = a;
+        event.data.keyboard.keychar = b;
+        break;
+    case EVENT_MOUSE_WHEEL:
+        event.data.wheel.amount = code;
+        event.data.wheel.clicks = a;
+        event.data.wheel.rotation = int16_t(b);
+        event.data.wheel.x = x;
+        event.data.wheel.y = y;
+        event.data.wheel.type = aux & 0xf;
+        event.data.wheel.direction = aux >> 4;
+        break;
+    default:
+        event.data.mouse.button = code;
+        event.data.mouse.clicks = a;
+        event.data.mouse.x = x;
+        event.data.mouse.y = y;
+    }
+    return true;
+}
+
+namespace input_recorder {
+/* One queue per producer thread, the writer thread is the only consumer */
+static spsc_queue<io_record, IO_REC_QUEUE_SIZE> hook_events;
+static spsc_queue<io_record, IO_REC_QUEUE_SIZE> pad_events;
+static std::atomic<bool> recording{false};
+static std::atomic<bool> running{false};
+static std::thread writer;
+static FILE *file = nullptr;
+static uint64_t start_time = 0;
+
+/* Writer thread state */
+static input_data state;
+static uint64_t last_time = 0;
+static uint64_t last_keyframe = 0;
+static std::vector<io_record> batch, out;
+
+static void write_keyframe(const uint64_t time)
+{
+    out.emplace_back(io_record::state(IO_REC_KEYFRAME, 0, 0.f, time));
+
+    for (uint16_t i = 0; i < IO_KEY_COUNT; i++) {
+        if (state.keyboard.test(i))
+            out.emplace_back(io_record::state(IO_REC_STATE_KEY, i, 1.f, time));
+    }
+
+    for (uint16_t i = 0; i < IO_MOUSE_BUTTON_COUNT; i++) {
+        if (state.mouse.test(i))
+            out.emplace_back(io_record::state(IO_REC_STATE_MOUSE, i, 1.f, time));
+    }
+
+    for (uint16_t i = 0; i < IO_PAD_BUTTON_COUNT; i++) {
+        if (state.gamepad_buttons.test(i))
+            out.emplace_back(io_record::state(IO_REC_STATE_PAD_BUTTON, i, 1.f, time));
+    }
+
+    for (uint16_t i = 0; i < IO_PAD_AXIS_COUNT; i++) {
+        if (state.gamepad_axis[i] != 0.f)
+            out.emplace_back(io_record::state(IO_REC_STATE_PAD_AXIS, i, state.gamepad_axis[i], time));
+    }
+
+    /* Mouse movement elements need the last position */
+    uiohook_event move{};
+    move.type = EVENT_MOUSE_MOVED;
+    move.data.mouse = state.last_mouse_movement;
+    out.emplace_back(io_record::from_event(&move, time));
+
+    last_keyframe = time;
+}
+
+static void write_batch()
+{
+    io_record r{};
+    while (hook_events.pop(r))
+        batch.emplace_back(r);
+    while (pad_events.pop(r))
+        batch.emplace_back(r);
+
+    /* out can still hold the initial keyframe from start() */
+    if (batch.empty() && out.empty())
+        return;
+
+    /* Both queues are ordered on their own, but not with each other */
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const io_record &a, const io_record &b) { return a.time < b.time; });
+
+    for (auto &record : batch) {
+        /* Timestamps are absolute until here, events from before the start are clamped */
+        record.time = std::max(last_time, record.time > start_time ? record.time - start_time : 0);
+        last_time = record.time;
+
+        if (record.time - last_keyframe >= IO_REC_KEYFRAME_NS)
+            write_keyframe(record.time);
+        record.apply(state);
+        out.emplace_back(record);
+    }
+
+    if (fwrite(out.data(), sizeof(io_record), out.size(), file) != out.size())
+        berr("Failed to write %zu records to input recording", out.size());
+    batch.clear();
+    out.clear();
+}
+
+static void writer_loop()
+{
+    while (running) {
+        write_batch();
+        os_sleep_ms(IO_REC_FLUSH_INTERVAL_MS);
+    }
+    write_batch();
+}
+
+bool start(const std::string &path)
+{
+    stop();
+
+    file = os_fopen(path.c_str(), "wb");
+    if (!file) {
+        berr("Couldn't open '%s' for input recording", path.c_str());
+        return false;
+    }
+
+    /* Events left over from a previous recording, nothing is producing right now */
+    io_record r{};
+    while (hook_events.pop(r)) {
+    }
+    while (pad_events.pop(r)) {
+    }
+
+    start_time = os_gettime_ns();
+    io_record_header header{};
+    memcpy(header.magic, IO_REC_MAGIC, sizeof(header.magic));
+    header.version = IO_REC_VERSION;
+    header.record_size = sizeof(io_record);
+    header.start_time = start_time;
+    fwrite(&header, sizeof(header), 1, file);
+
+    /* Input state before the recording started is unknown */
+    state = input_data{};
+    last_time = 0;
+    write_keyframe(0);
+
+    running = true;
+    writer = std::thread(writer_loop);
+    recording = true;
+    binfo("Started input recording to '%s'", path.c_str());
+    return true;
+}
+
+void stop()
+{
+    if (!running)
+        return;
+
+    recording = false;
+    running = false;
+    writer.join();
+
+    const auto dropped = hook_events.dropped() + pad_events.dropped();
+    if (dropped)
+        bwarn("Input recording dropped %u events, the writer couldn't keep up", dropped);
+
+    fclose(file);
+    file = nullptr;
+    binfo("Stopped input recording, %.1f seconds recorded", last_time / 1e9);
+}
+
+bool active()
+{
+    return recording.load(std::memory_order_relaxed);
+}
+
+void record(const uiohook_event *event)
+{
+    if (event->type != EVENT_HOOK_ENABLED && event->type != EVENT_HOOK_DISABLED)
+        hook_events.push(io_record::from_event(event, os_gettime_ns()));
+}
+
+void record_pad(const gamepad::input_event *event, const bool axis, const uint8_t device, const uint64_t time)
+{
+    pad_events.push(io_record::from_pad_event(event, axis, device, time));
+}
+}
+
+bool input_replay::open(const std::string &path)
+{
+    close();
+
+    if (!m_file.open(path.c_str())) {
+        berr("Couldn't open input recording '%s'", path.c_str());
+        return false;
+    }
+
+    io_record_header header{};
+    if (m_file.size() < sizeof(header)) {
+        berr("'%s' is not an input recording", path.c_str());
+        m_file.close();
+        return false;
+    }
+
+    memcpy(&header, m_file.data(), sizeof(header));
+    if (memcmp(header.magic, IO_REC_MAGIC, sizeof(header.magic)) != 0 || header.version != IO_REC_VERSION ||
+        header.record_size != sizeof(io_record)) {
+        berr("'%s' is not an input recording or has an unsupported version", path.c_str());
+        m_file.close();
+        return false;
+    }
+
+    /* A recording which wasn't stopped properly can end with a partial record */
+    m_count = (m_file.size() - sizeof(header)) / sizeof(io_record);
+    if (!m_count) {
+        berr("Input recording '%s' doesn't contain any input", path.c_str());
+        m_file.close();
+        return false;
+    }
+
+    m_records = reinterpret_cast<const io_record *>(m_file.data() + sizeof(header));
+    m_path = path;
+    m_duration = m_records[m_count - 1].time;
+    m_last_frame = 0;
+    m_seek_to = 0;
+    m_state = replay_state::playing;
+    return true;
+}
+
+void input_replay::close()
+{
+    m_file.close();
+    m_path.clear();
+    m_records = nullptr;
+    m_count = 0;
+    m_cursor = 0;
+    m_position = 0;
+    m_duration = 0;
+    m_seek_to = UINT64_MAX;
+    m_state = replay_state::none;
+    m_state_data = input_data{};
+    m_latch.clear();
+    m_data = input_data{};
+}
+
+void input_replay::seek(const uint64_t position)
+{
+    m_seek_to = position;
+}
+
+void input_replay::set_paused(const bool paused)
+{
+    if (m_state == replay_state::none)
+        return;
+    if (!paused && m_state == replay_state::ended)
+        m_seek_to = 0;
+    m_state = paused ? replay_state::paused : replay_state::playing;
+}
+
+void input_replay::restart()
+{
+    if (m_state == replay_state::none)
+        return;
+    m_seek_to = 0;
+    m_state = replay_state::playing;
+}
+
+void input_replay::stop()
+{
+    if (m_state == replay_state::none)
+        return;
+    m_seek_to = 0;
+    m_state = replay_state::stopped;
+}
+
+void input_replay::apply_seek(uint64_t position)
+{
+    position = std::min(position, uint64_t(m_duration));
+
+    /* First record after the position */
+    const auto end = std::upper_bound(m_records, m_records + m_count, position,
+                                      [](uint64_t t, const io_record &r) { return t < r.time; });
+
+    /* Keyframes are at most IO_REC_KEYFRAME_NS of events apart */
+    auto begin = end;
+    while (begin != m_records && begin[-1].type != IO_REC_KEYFRAME)
+        --begin;
+    if (begin != m_records)
+        --begin;
+
+    m_state_data = input_data{};
+    m_last_wheel = 0;
+    for (auto *r = begin; r != end; ++r)
+        step(*r);
+
+    m_latch.clear();
+    m_cursor = size_t(end - m_records);
+    m_position = position;
+}
+
+void input_replay::step(const io_record &record)
+{
+    record.apply(m_state_data);
+
+    const auto code = record.press_code();
+    if (code != VC_NONE)
+        m_latch.add({record.time, code});
+    else if (record.type == EVENT_MOUSE_WHEEL)
+        m_last_wheel = record.time;
+}
+
+void input_replay::tick(const uint64_t frame_time)
+{
+    if (!m_records)
+        return;
+
+    const auto delta = m_last_frame ? frame_time - m_last_frame : 0;
+    m_last_frame = frame_time;
+
+    /* After seeking playback continues from the new position with the next tick */
+    const auto seek_to = m_seek_to.exchange(UINT64_MAX);
+    if (seek_to != UINT64_MAX)
+        apply_seek(seek_to);
+
+    m_latch.clear();
+    if (m_state == replay_state::playing && seek_to == UINT64_MAX) {
+        auto position = m_position + delta;
+        if (position > m_duration) {
+            if (m_loop) {
+                apply_seek(0);
+                position = 0;
+            } else {
+                position = m_duration;
+                m_state = replay_state::ended;
+            }
+        }
+
+        while (m_cursor < m_count && m_records[m_cursor].time <= position)
+            step(m_records[m_cursor++]);
+        m_position = position;
+    }
+
+    if (m_last_wheel && m_position - m_last_wheel >= IO_REC_WHEEL_TIMEOUT_NS) {
+        m_last_wheel = 0;
+        m_state_data.last_wheel_event = {};
+    }
+
+    m_data = m_state_data;
+    m_latch.apply(m_data);
+}
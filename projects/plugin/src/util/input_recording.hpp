@@ -0,0 +1,158 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include "input_data.hpp"
+#include "mapped_file.hpp"
+#include <atomic>
+#include <string>
+
+/* Input recordings (*.iorec) are a 16 byte header followed by fixed size
+ * records in native byte order, appended in timestamp order. Every
+ * IO_REC_KEYFRAME_NS a keyframe (the full input state as a run of state records)
+ * is written before the next event, so playback can seek by binary searching
+ * the record times and replaying at most one keyframe interval */
+#define IO_REC_MAGIC "IORC"
+#define IO_REC_VERSION 1
+#define IO_REC_EXTENSION "iorec"
+#define IO_REC_KEYFRAME_NS (1000ull * 1000 * 1000)
+/* Events buffered per hook thread until the writer thread picks them up */
+#define IO_REC_QUEUE_SIZE 4096
+#define IO_REC_FLUSH_INTERVAL_MS 10
+/* Wheel events don't have a release, so they're cleared after this in playback */
+#define IO_REC_WHEEL_TIMEOUT_NS (120ull * 1000 * 1000)
+
+/* Record types below IO_REC_PAD_BUTTON are uiohook event types */
+enum io_record_type : uint8_t {
+    IO_REC_PAD_BUTTON = 0x40,
+    IO_REC_PAD_AXIS,
+    IO_REC_KEYFRAME = 0x80, /* Resets the state, followed by the state records below */
+    IO_REC_STATE_KEY,       /* code = key_index() */
+    IO_REC_STATE_MOUSE,     /* code = mouse bit */
+    IO_REC_STATE_PAD_BUTTON,
+    IO_REC_STATE_PAD_AXIS
+};
+
+struct io_record_header {
+    char magic[4];
+    uint16_t version;
+    uint16_t record_size;
+    uint64_t start_time; /* os_gettime_ns() when recording started */
+};
+
+/* One input event, field usage depends on the type:
+ * keys:        code = keycode, a = rawcode, b = keychar
+ * mouse:       code = button, a = clicks, x/y = position
+ * wheel:       code = amount, a = clicks, b = rotation, x/y = position, aux = type | direction << 4
+ * gamepad:     code = libgamepad button/axis id, a = native id, x/y = raw value, aux = device index
+ * state:       code = table index, value = axis value/button state */
+struct io_record {
+    uint64_t time; /* Nanoseconds since the recording started */
+    uint8_t type;
+    uint8_t aux;
+    uint16_t code;
+    int16_t x, y;
+    uint16_t a, b;
+    float value;
+
+    static io_record from_event(const uiohook_event *event, uint64_t time);
+    static io_record from_pad_event(const gamepad::input_event *event, bool axis, uint8_t device, uint64_t time);
+    static io_record state(io_record_type type, uint16_t index, float value, uint64_t time);
+
+    /* Fills in the uiohook event for this record, false if it isn't one */
+    bool to_event(uiohook_event &event) const;
+
+    /* VC_NONE unless this is a key or mouse press, see input_data::press_code */
+    uint16_t press_code() const;
+
+    /* Applies the record to data the same way the live hooks would */
+    void apply(input_data &data) const;
+};
+
+static_assert(sizeof(io_record_header) == 16, "io_record_header is written as is");
+static_assert(sizeof(io_record) == 24, "io_record is written as is");
+
+/* Writes the local input to a recording. Events are queued by the hook threads
+ * and written by a separate thread, so disk I/O never stalls the hooks */
+namespace input_recorder {
+bool start(const std::string &path);
+
+void stop();
+
+/* Cheap enough to check for every event */
+bool active();
+
+/* uiohook thread */
+void record(const uiohook_event *event);
+
+/* libgamepad hook thread or gamepad monitor, time is on the os_gettime_ns() clock */
+void record_pad(const gamepad::input_event *event, bool axis, uint8_t device, uint64_t time);
+}
+
+enum class replay_state { none, playing, paused, stopped, ended };
+
+/* Plays back a memory mapped recording. Playback runs on the video thread,
+ * the controls and getters only touch atomics and are safe to call from any thread */
+class input_replay {
+public:
+    bool open(const std::string &path);
+    void close();
+    bool is_open() const { return m_records != nullptr; }
+    const std::string &path() const { return m_path; }
+
+    /* Advances playback by the time since the last tick and applies all
+     * records up to the new position, video thread only */
+    void tick(uint64_t frame_time);
+
+    /* Jumps to a position in nanoseconds since the start of the recording on the next tick */
+    void seek(uint64_t position);
+
+    void set_paused(bool paused);
+    void restart();
+    void stop();
+    void set_loop(bool loop) { m_loop = loop; }
+
+    uint64_t position() const { return m_position; }
+    uint64_t duration() const { return m_duration; }
+    replay_state state() const { return m_state; }
+
+    const input_data &data() const { return m_data; }
+
+private:
+    void apply_seek(uint64_t position);
+    void step(const io_record &record);
+
+    mapped_file m_file;
+    std::string m_path;
+    const io_record *m_records = nullptr;
+    size_t m_count = 0;
+    size_t m_cursor = 0; /* Next record to apply */
+    uint64_t m_last_frame = 0;
+    uint64_t m_last_wheel = 0;
+    bool m_loop = false;
+
+    std::atomic<uint64_t> m_seek_to{UINT64_MAX};
+    std::atomic<uint64_t> m_position{0};
+    std::atomic<uint64_t> m_duration{0};
+    std::atomic<replay_state> m_state{replay_state::none};
+
+    input_data m_state_data{}; /* State at the current position */
+    input_latch m_latch{};     /* Presses since the last tick */
+    input_data m_data{};       /* State plus latched presses */
+};
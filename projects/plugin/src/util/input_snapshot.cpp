@@ -0,0 +1,147 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "input_snapshot.hpp"
+#include "config.hpp"
+#include "latency.hpp"
+#include "../hook/gamepad_hook_helper.hpp"
+#include "../hook/uiohook_helper.hpp"
+#include "../network/io_server.hpp"
+#include "../network/remote_connection.hpp"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+const input_data input_snapshot::empty{};
+
+namespace local_data {
+/* Presses drained from the hook thread for the current frame */
+static input_latch latch;
+static uint64_t latch_frame_time = 0;
+
+static void drain_presses(const uint64_t frame_time)
+{
+    if (frame_time == latch_frame_time)
+        return;
+    latch_frame_time = frame_time;
+    latch.clear();
+
+    input_press press;
+    while (presses.pop(press)) {
+        if (press.time + IO_PRESS_MAX_AGE_NS >= frame_time)
+            latch.add(press);
+    }
+}
+}
+
+input_snapshot::input_snapshot(const uint8_t origin, std::shared_ptr<gamepad::device> pad)
+    : m_origin(origin), m_pad(std::move(pad))
+{
+}
+
+void input_snapshot::refresh(const uint64_t frame_time)
+{
+    if (frame_time == m_frame_time)
+        return;
+    m_frame_time = frame_time;
+
+    /* The overlay keeps showing the last state while input is blocked */
+    const auto blocked = io_config::io_window_filters.input_blocked();
+
+    /* Input data is read from snapshots published by the hook/network threads,
+     * so this never waits on them. network::mutex only guards the client list,
+     * which is only changed when clients (dis)connect */
+    if (network::server_instance && m_origin > 0) {
+        if (network::network_flag && !blocked) {
+            std::lock_guard<std::mutex> lock(network::mutex);
+            auto *client = network::server_instance->get_client(m_origin - 1);
+            if (client)
+                m_data.copy(&client->read_data());
+        }
+    } else {
+        /* The snapshot has to be read before the presses are drained,
+         * see uiohook::process_event. Presses are drained even while
+         * blocked, so no stale ones pile up */
+        const auto &local = local_data::snapshot.read();
+        local_data::drain_presses(frame_time);
+
+        if (!blocked) {
+            m_data.copy(&local);
+            local_data::latch.apply(m_data);
+        }
+    }
+
+    if (blocked)
+        return;
+
+    if (m_pad) {
+        libgamepad::hook_instance->get_mutex()->lock();
+        m_pad_index = m_pad->get_index();
+        /* Read before the state, so the copy is at least as new as the stamp */
+        m_pad_event_time = latency::pad_stamp(m_pad_index);
+        m_data.copy_gamepad(m_pad);
+        libgamepad::hook_instance->get_mutex()->unlock();
+    }
+}
+
+void input_snapshot::rendered()
+{
+    /* Only the first source drawing this frame counts */
+    if (m_render_time == m_frame_time)
+        return;
+    m_render_time = m_frame_time;
+
+    const auto now = os_gettime_ns();
+    auto *histogram = latency::get(latency::input_slot(m_origin));
+    if (histogram && m_data.event_time)
+        histogram->record_event(m_data.event_time, now);
+
+    histogram = m_pad ? latency::get(latency::pad_slot(m_pad_index)) : nullptr;
+    if (histogram && m_pad_event_time)
+        histogram->record_event(m_pad_event_time, now);
+}
+
+namespace input_snapshots {
+static std::mutex mutex;
+static std::vector<std::weak_ptr<input_snapshot>> snapshots;
+
+std::shared_ptr<input_snapshot> acquire(const uint8_t origin, const std::shared_ptr<gamepad::device> &pad)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<input_snapshot> result;
+
+    /* Drop snapshots no source uses anymore */
+    snapshots.erase(std::remove_if(snapshots.begin(), snapshots.end(),
+                                   [](const std::weak_ptr<input_snapshot> &s) { return s.expired(); }),
+                    snapshots.end());
+
+    for (const auto &s : snapshots) {
+        auto snapshot = s.lock();
+        if (snapshot && snapshot->origin() == origin && snapshot->pad() == pad.get()) {
+            result = snapshot;
+            break;
+        }
+    }
+
+    if (!result) {
+        result = std::make_shared<input_snapshot>(origin, pad);
+        snapshots.emplace_back(result);
+    }
+    return result;
+}
+}
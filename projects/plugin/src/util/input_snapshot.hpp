@@ -0,0 +1,62 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include "input_data.hpp"
+#include <memory>
+
+/* A refreshed copy of the input data for one input origin (local input or a
+ * remote client, plus the selected gamepad). All sources reading from the same
+ * origin share one instance, which is only refreshed once per video frame, so
+ * the per frame cost scales with the number of distinct inputs in use, not
+ * with the number of sources */
+class input_snapshot {
+public:
+    input_snapshot(uint8_t origin, std::shared_ptr<gamepad::device> pad);
+
+    /* Only the first call per frame copies any data, video thread only */
+    void refresh(uint64_t frame_time);
+
+    /* Called after drawing, records how long the newest events in data()
+     * took from the hook/network thread to the screen, video thread only */
+    void rendered();
+
+    const input_data &data() const { return m_data; }
+    uint8_t origin() const { return m_origin; }
+    const gamepad::device *pad() const { return m_pad.get(); }
+
+    /* Used by sources, which haven't been refreshed yet */
+    static const input_data empty;
+
+private:
+    input_data m_data{};
+    uint64_t m_frame_time = 0;
+    uint64_t m_render_time = 0; /* Frame time of the last rendered() call */
+    uint64_t m_pad_event_time = 0;
+    int m_pad_index = -1;
+    uint8_t m_origin; /* 0 = Local input, 0< remote computers */
+    std::shared_ptr<gamepad::device> m_pad;
+};
+
+namespace input_snapshots {
+/* Returns the snapshot shared by all sources with this origin and gamepad
+ * and creates it if none exists. Snapshots are released once no source
+ * holds on to them anymore */
+std::shared_ptr<input_snapshot> acquire(uint8_t origin, const std::shared_ptr<gamepad::device> &pad);
+}
@@ -42,6 +42,19 @@
 #define T_MONITOR_USE_CENTER            T_("Mouse.UseCenter")
 #define T_MONITOR_H_CENTER              T_("Monitor.CenterX")
 #define T_MONITOR_V_CENTER              T_("Monitor.CenterY")
+#define T_MIN_VISIBLE                   T_("Overlay.MinVisible")
+#define T_INPUT_MODE                    T_("Overlay.InputMode")
+#define T_INPUT_MODE_LIVE               T_("Overlay.InputMode.Live")
+#define T_INPUT_MODE_REPLAY             T_("Overlay.InputMode.Replay")
+#define T_REPLAY_FILE                   T_("Overlay.Path.Replay")
+#define T_REPLAY_LOOP                   T_("Overlay.Replay.Loop")
+#define T_FILTER_RECORDING_FILES        T_("Filter.RecordingFiles")
+#define T_FILTER_JSON_FILES             T_("Filter.JsonFiles")
+#define T_FILTER_LAYOUT_FILES           T_("Filter.LayoutFiles")
+#define T_LATENCY_REMOTE                T_("Dialog.Latency.Remote")
+#define T_LATENCY_GAMEPAD               T_("Dialog.Latency.Gamepad")
+#define T_LATENCY_EXPORT                T_("Dialog.Latency.Export")
+#define T_LATENCY_EXPORT_FAILED         T_("Dialog.Latency.Export.Failed")
 
 /* Lang Input History */
 #define T_HISTORY_USE_FALLBACK_NAMES    T_("History.UseFallbackNames")
@@ -0,0 +1,165 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "latency.hpp"
+#include <algorithm>
+
+size_t latency_histogram::bucket_index(uint64_t us)
+{
+    if (us < IO_LATENCY_SUB_BUCKETS)
+        return size_t(us);
+
+    int msb = IO_LATENCY_SUB_BITS;
+    while (msb < 63 && (us >> (msb + 1)))
+        msb++;
+
+    const auto shift = msb - IO_LATENCY_SUB_BITS;
+    const auto sub = size_t(us >> shift) & (IO_LATENCY_SUB_BUCKETS - 1);
+    return std::min(size_t(shift + 1) * IO_LATENCY_SUB_BUCKETS + sub, size_t(IO_LATENCY_BUCKETS - 1));
+}
+
+uint64_t latency_histogram::bucket_floor(const size_t index)
+{
+    if (index < IO_LATENCY_SUB_BUCKETS)
+        return index;
+    const auto shift = index / IO_LATENCY_SUB_BUCKETS - 1;
+    return uint64_t(IO_LATENCY_SUB_BUCKETS + index % IO_LATENCY_SUB_BUCKETS) << shift;
+}
+
+void latency_histogram::record_event(const uint64_t stamp, const uint64_t now)
+{
+    auto last = m_last_stamp.load(std::memory_order_relaxed);
+    if (stamp <= last)
+        return;
+    if (!m_last_stamp.compare_exchange_strong(last, stamp, std::memory_order_relaxed))
+        return;
+
+    const auto age = now > stamp ? now - stamp : 0;
+    if (age < IO_LATENCY_MAX_AGE_NS)
+        record(age);
+}
+
+void latency_histogram::record(const uint64_t ns)
+{
+    const auto us = ns / 1000;
+    m_buckets[bucket_index(us)].fetch_add(1, std::memory_order_relaxed);
+
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (us > max && !m_max.compare_exchange_weak(max, us, std::memory_order_relaxed))
+        ;
+}
+
+latency_stats latency_histogram::stats() const
+{
+    latency_stats result;
+    std::vector<uint32_t> counts;
+    buckets(counts);
+
+    for (const auto c : counts)
+        result.samples += c;
+    if (result.samples == 0)
+        return result;
+
+    const uint64_t targets[] = {(result.samples * 50 + 99) / 100, (result.samples * 95 + 99) / 100,
+                                (result.samples * 99 + 99) / 100};
+    uint64_t *values[] = {&result.p50, &result.p95, &result.p99};
+    uint64_t seen = 0;
+    size_t next = 0;
+    result.max = m_max.load(std::memory_order_relaxed);
+
+    /* Percentiles are reported as the upper end of their bucket,
+     * so they never look better than they are */
+    for (size_t i = 0; i < counts.size() && next < 3; i++) {
+        seen += counts[i];
+        while (next < 3 && seen >= targets[next])
+            *values[next++] = std::min(bucket_floor(i + 1) - 1, result.max);
+    }
+    return result;
+}
+
+void latency_histogram::buckets(std::vector<uint32_t> &out) const
+{
+    out.resize(IO_LATENCY_BUCKETS);
+    for (size_t i = 0; i < IO_LATENCY_BUCKETS; i++)
+        out[i] = m_buckets[i].load(std::memory_order_relaxed);
+}
+
+void latency_histogram::reset()
+{
+    /* Not atomic as a whole, samples recorded during a reset might survive it */
+    for (auto &b : m_buckets)
+        b.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+namespace latency {
+static std::atomic<latency_histogram *> histograms[IO_LATENCY_SLOTS]{};
+static std::atomic<uint64_t> pad_stamps[IO_LATENCY_MAX_PADS]{};
+
+latency_histogram *get(const size_t slot)
+{
+    if (slot >= IO_LATENCY_SLOTS)
+        return nullptr;
+
+    auto *h = histograms[slot].load(std::memory_order_acquire);
+    if (h)
+        return h;
+
+    /* Only happens once per origin, if two threads race here one of them drops its copy */
+    auto *created = new latency_histogram;
+    if (histograms[slot].compare_exchange_strong(h, created, std::memory_order_acq_rel))
+        return created;
+    delete created;
+    return h;
+}
+
+const latency_histogram *find(const size_t slot)
+{
+    if (slot >= IO_LATENCY_SLOTS)
+        return nullptr;
+    return histograms[slot].load(std::memory_order_acquire);
+}
+
+void stamp_pad(const int index, const uint64_t time)
+{
+    if (index >= 0 && index < IO_LATENCY_MAX_PADS)
+        pad_stamps[index].store(time, std::memory_order_relaxed);
+}
+
+uint64_t pad_stamp(const int index)
+{
+    if (index >= 0 && index < IO_LATENCY_MAX_PADS)
+        return pad_stamps[index].load(std::memory_order_relaxed);
+    return 0;
+}
+
+void reset()
+{
+    for (auto &h : histograms) {
+        auto *histogram = h.load(std::memory_order_acquire);
+        if (histogram)
+            histogram->reset();
+    }
+}
+
+void release_all()
+{
+    for (auto &h : histograms)
+        delete h.exchange(nullptr);
+}
+}
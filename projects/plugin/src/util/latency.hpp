@@ -0,0 +1,101 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/* Latencies are stored in µs, with 16 linear sub buckets for every
+ * power of two, so any value is off by at most ~6% */
+#define IO_LATENCY_SUB_BITS 4
+#define IO_LATENCY_SUB_BUCKETS (1 << IO_LATENCY_SUB_BITS)
+#define IO_LATENCY_BUCKETS (IO_LATENCY_SUB_BUCKETS * 36) /* Larger values end up in the last bucket */
+
+/* Events which took longer than this to be shown weren't visible in any source
+ * (e.g. input was blocked or no source existed) and are not counted */
+#define IO_LATENCY_MAX_AGE_NS (1000 * 1000 * 1000ull)
+
+/* One histogram per input origin. Slot 0 is local input,
+ * 1-255 are remote clients (same numbering as input_snapshot::origin)
+ * and the rest are gamepads by their libgamepad index */
+#define IO_LATENCY_MAX_PADS 16
+#define IO_LATENCY_PAD_SLOT 256
+#define IO_LATENCY_SLOTS (IO_LATENCY_PAD_SLOT + IO_LATENCY_MAX_PADS)
+
+struct latency_stats {
+    uint64_t samples = 0;
+    /* In microseconds */
+    uint64_t p50 = 0, p95 = 0, p99 = 0, max = 0;
+};
+
+/* Log-linear histogram of the time between an input event arriving on the
+ * hook/network thread and the first frame rendering it. Recording only does
+ * relaxed atomic increments, so the video thread never waits on readers */
+class latency_histogram {
+public:
+    /* Records now - stamp, unless the event with this stamp was already recorded.
+     * Every source sharing the same input calls this, so an event
+     * is only counted by the first frame which shows it */
+    void record_event(uint64_t stamp, uint64_t now);
+    void record(uint64_t ns);
+
+    latency_stats stats() const;
+    /* Number of samples in each bucket, see bucket_floor */
+    void buckets(std::vector<uint32_t> &out) const;
+    void reset();
+
+    static size_t bucket_index(uint64_t us);
+    /* Lowest value in µs which ends up in this bucket */
+    static uint64_t bucket_floor(size_t index);
+
+private:
+    std::atomic<uint32_t> m_buckets[IO_LATENCY_BUCKETS]{};
+    std::atomic<uint64_t> m_max{0};
+    std::atomic<uint64_t> m_last_stamp{0};
+};
+
+namespace latency {
+inline size_t input_slot(uint8_t origin)
+{
+    return origin;
+}
+
+/* Out of range indices map to IO_LATENCY_SLOTS, for which get() returns nullptr */
+inline size_t pad_slot(int index)
+{
+    return index >= 0 && index < IO_LATENCY_MAX_PADS ? IO_LATENCY_PAD_SLOT + size_t(index) : IO_LATENCY_SLOTS;
+}
+
+/* Histogram for this slot, created on first use. Lives until latency::release_all() */
+latency_histogram *get(size_t slot);
+
+/* Histogram if anything was recorded for this slot, nullptr otherwise */
+const latency_histogram *find(size_t slot);
+
+/* Time of the latest event of a gamepad, set by the gamepad thread */
+void stamp_pad(int index, uint64_t time);
+uint64_t pad_stamp(int index);
+
+void reset();
+
+/* Deletes all histograms, on unload */
+void release_all();
+}
@@ -0,0 +1,210 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "layout_cache.hpp"
+#include "log.h"
+#include "mapped_file.hpp"
+#include "obs_util.hpp"
+#include "texture_cache.hpp"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+namespace layout_cache {
+struct entry {
+    std::string path; /* Canonical path */
+    int64_t mtime;
+    std::weak_ptr<const compiled_layout> layout;
+};
+
+static std::mutex mutex;
+static std::vector<entry> entries;
+static std::vector<std::string> loading; /* Canonical paths which are being parsed */
+static std::condition_variable loaded;
+
+static const char *element_type_to_string(const element_type t)
+{
+    switch (t) {
+    case ET_TEXTURE:
+        return "Texture";
+    case ET_BUTTON:
+        return "Button";
+    case ET_ANALOG_STICK:
+        return "Analog stick";
+    case ET_WHEEL:
+        return "Scroll wheel";
+    case ET_MOUSE_STATS:
+        return "Mouse movement";
+    case ET_TRIGGER:
+        return "Trigger";
+    case ET_GAMEPAD_ID:
+        return "Gamepad ID";
+    case ET_DPAD_STICK:
+        return "DPad";
+    default:
+    case ET_INVALID:
+        return "Invalid";
+    }
+}
+
+/* Only checks what's needed to safely read the file, the values themselves
+ * are used as is, like the ones from a json layout */
+static std::shared_ptr<compiled_layout> load_binary(const std::string &path)
+{
+    mapped_file file;
+    if (!file.open(path.c_str())) {
+        berr("Couldn't open layout %s", path.c_str());
+        return nullptr;
+    }
+
+    io_layout_header header;
+    if (file.size() < sizeof(header)) {
+        berr("%s is not a layout file", path.c_str());
+        return nullptr;
+    }
+
+    memcpy(&header, file.data(), sizeof(header));
+    const auto atlas_size = uint64_t(header.atlas_width) * header.atlas_height * 4;
+    const auto elements_size = uint64_t(header.element_count) * sizeof(io_layout_element);
+    if (memcmp(header.magic, IO_LAYOUT_MAGIC, sizeof(header.magic)) != 0 || header.version != IO_LAYOUT_VERSION ||
+        header.element_size != sizeof(io_layout_element) ||
+        file.size() < sizeof(header) + elements_size + atlas_size) {
+        berr("%s is not a layout file or was made by a different version of io-cct", path.c_str());
+        return nullptr;
+    }
+
+    auto layout = std::make_shared<compiled_layout>();
+    layout->cx = header.width;
+    layout->cy = header.height;
+    layout->flags = static_cast<uint8_t>(header.flags);
+
+    const auto *elements = file.data() + sizeof(header);
+    for (uint32_t i = 0; i < header.element_count; i++) {
+        io_layout_element e;
+        memcpy(&e, elements + i * sizeof(e), sizeof(e));
+        e.id[IO_LAYOUT_ID_LENGTH - 1] = '\0';
+        layout->program.add(e, false);
+    }
+    layout->program.finish(layout->flags);
+
+    if (header.atlas_width && header.atlas_height) {
+        const auto *pixels = elements + elements_size;
+        layout->atlas = texture_cache::create(header.atlas_width, header.atlas_height, pixels);
+    }
+    return layout;
+}
+
+static std::shared_ptr<compiled_layout> load_json(const std::string &path)
+{
+    QFile file(path.c_str());
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        blog(LOG_ERROR, "[input-overlay] couldn't open config file");
+        return nullptr;
+    }
+
+    QJsonParseError err;
+    const auto cfg_doc = QJsonDocument::fromJson(file.readAll(), &err);
+
+    if (err.error != QJsonParseError::NoError) {
+        berr("Couldn't load layout from %s. Error: %s", path.c_str(), qt_to_utf8(err.errorString()));
+        return nullptr;
+    }
+
+    auto cfg_obj = cfg_doc.object();
+    auto layout = std::make_shared<compiled_layout>();
+    layout->cx = static_cast<uint32_t>(cfg_obj[CFG_TOTAL_WIDTH].toInt());
+    layout->cy = static_cast<uint32_t>(cfg_obj[CFG_TOTAL_HEIGHT].toInt());
+    layout->flags = static_cast<uint8_t>(cfg_obj[CFG_FLAGS].toInt());
+
+    const auto debug_mode = cfg_obj[CFG_DEBUG_FLAG].toBool();
+
+#ifndef _DEBUG
+    if (debug_mode) {
+#else
+    {
+#endif
+        binfo("Started loading of %s", path.c_str());
+    }
+
+    auto arr = cfg_obj[CFG_ELEMENTS].toArray();
+
+    for (const auto element : arr) {
+        const auto obj = element.toObject();
+        if (!layout->program.add(obj, debug_mode))
+            continue;
+
+#ifndef _DEBUG
+        if (debug_mode) {
+#else
+        {
+#endif
+            const auto type = static_cast<element_type>(obj[CFG_TYPE].toInt());
+            binfo("Type: %14s, KEYCODE: 0x%04X ID: %s", element_type_to_string(type), obj[CFG_KEY_CODE].toInt(),
+                  qt_to_utf8(obj[CFG_ID].toString()));
+        }
+    }
+    layout->program.finish(layout->flags);
+    return layout;
+}
+
+std::shared_ptr<const compiled_layout> acquire(const std::string &path)
+{
+    std::string key;
+    int64_t mtime;
+    util_file_version(path, key, mtime);
+
+    std::shared_ptr<const compiled_layout> layout;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        /* Drop layouts no overlay uses anymore */
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](const entry &e) { return e.layout.expired(); }),
+                      entries.end());
+
+        for (const auto &e : entries) {
+            if (e.path == key && e.mtime == mtime && (layout = e.layout.lock()))
+                return layout;
+        }
+
+        /* Layouts are parsed outside of the lock, a file which is already being parsed is waited on */
+        if (std::find(loading.begin(), loading.end(), key) == loading.end())
+            break;
+        loaded.wait(lock);
+    }
+    loading.emplace_back(key);
+    lock.unlock();
+
+    const auto binary = path.size() > strlen(IO_LAYOUT_EXTENSION) &&
+                        path.compare(path.size() - strlen(IO_LAYOUT_EXTENSION), std::string::npos,
+                                     IO_LAYOUT_EXTENSION) == 0;
+    layout = binary ? load_binary(path) : load_json(path);
+
+    lock.lock();
+    loading.erase(std::find(loading.begin(), loading.end(), key));
+    loaded.notify_all();
+    if (layout)
+        entries.emplace_back(entry{key, mtime, layout});
+    return layout;
+}
+}
@@ -0,0 +1,46 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include "render_program.hpp"
+#include <memory>
+#include <string>
+
+typedef struct gs_image_file gs_image_file_t;
+
+/* A parsed and compiled layout file. Never modified after loading,
+ * so one instance is shared by all overlays using the same file */
+struct compiled_layout {
+    uint32_t cx = 0, cy = 0;
+    uint8_t flags = 0; /* See overlay_flags in layout_constants.hpp */
+    render_program program;
+    /* Atlas embedded in a *.iolayout file, used instead of the
+     * source's image file. Not uploaded yet, see texture_cache::create */
+    std::shared_ptr<gs_image_file_t> atlas;
+};
+
+namespace layout_cache {
+/* Returns the compiled layout for this file (json or *.iolayout), shared by all overlays using it.
+ * Like texture_cache, files are identified by canonical path and modification
+ * time, so only new or changed layouts are parsed. Layouts are released once
+ * no overlay holds on to them anymore. Returns nullptr if the file couldn't
+ * be read or parsed. Safe to call from several loader threads, a file wanted
+ * by more than one of them is only parsed once */
+std::shared_ptr<const compiled_layout> acquire(const std::string &path);
+}
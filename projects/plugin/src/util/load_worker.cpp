@@ -0,0 +1,80 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "load_worker.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace load_worker {
+static std::mutex mutex;
+static std::condition_variable wake;
+static std::deque<std::function<void()>> jobs;
+static std::vector<std::thread> workers;
+static bool running = false;
+
+static void worker_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [] { return !running || !jobs.empty(); });
+        if (!running)
+            break;
+
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        job();
+        job = nullptr; /* Whatever the job holds on to is released outside of the lock */
+        lock.lock();
+    }
+}
+
+void post(std::function<void()> job)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+        running = true;
+        /* One core is left for OBS itself */
+        const auto cores = std::thread::hardware_concurrency();
+        const auto count = std::min<unsigned>(cores > 1 ? cores - 1 : 1, LOAD_WORKER_MAX_THREADS);
+        for (unsigned i = 0; i < count; i++)
+            workers.emplace_back(worker_loop);
+    }
+    jobs.emplace_back(std::move(job));
+    wake.notify_one();
+}
+
+void stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+            return;
+        running = false;
+        wake.notify_all();
+    }
+    for (auto &worker : workers)
+        worker.join();
+    workers.clear();
+    jobs.clear();
+}
+}
@@ -0,0 +1,37 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <functional>
+
+/* Maximum number of loader threads, loading is mostly decoding images */
+#define LOAD_WORKER_MAX_THREADS 8
+
+/* Background threads for loading overlay files (decoding images, parsing
+ * layouts), so neither the UI nor the video thread waits on the disk.
+ * When a scene collection is opened every source posts its load at once,
+ * so they're spread over one thread per core (up to LOAD_WORKER_MAX_THREADS).
+ * Jobs start in the order they were posted, but can finish in any order */
+namespace load_worker {
+/* Starts the threads on first use */
+void post(std::function<void()> job);
+
+/* Waits for the running jobs, jobs which haven't started yet are dropped */
+void stop();
+}
@@ -16,28 +16,42 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *************************************************************************/
 
-#include "element_button.hpp"
-#include <keycodes.h>
+#include "mapped_file.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-#include "src/sources/input_source.hpp"
-
-void element_button::load(const QJsonObject &obj)
+bool mapped_file::open(const char *path)
 {
-    element_texture::load(obj);
-    m_keycode = static_cast<uint16_t>(obj[CFG_KEY_CODE].toInt());
-    m_pressed = m_mapping;
-    m_pressed.y = m_mapping.y + m_mapping.cy + CFG_INNER_BORDER;
+    close();
+
+    const auto fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    /* The mapping stays valid after the descriptor is closed */
+    auto *data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    madvise(data, size_t(st.st_size), MADV_RANDOM);
+    m_data = static_cast<const uint8_t *>(data);
+    m_size = size_t(st.st_size);
+    return true;
 }
 
-void element_button::draw(gs_effect_t *effect, gs_image_file_t *image, sources::overlay_settings *settings)
+void mapped_file::close()
 {
-    /* TODO: this should only check either mouse buttons,
-     * keyboard keys or gamepad buttons
-     */
-    if (settings->data.gamepad_buttons[m_keycode] || settings->data.keyboard[m_keycode] ||
-        settings->data.mouse[m_keycode]) {
-        element_texture::draw(effect, image, &m_pressed);
-    } else {
-        element_texture::draw(effect, image, nullptr);
-    }
+    if (m_data)
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
 }
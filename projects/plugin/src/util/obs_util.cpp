@@ -21,6 +21,8 @@
 #include "lang.h"
 #include <QFile>
 #include <QDir>
+#include <QDateTime>
+#include <QFileInfo>
 
 QString util_get_data_file(const QString &file_name)
 {
@@ -78,6 +80,16 @@ bool util_open_json(const QString &path, QJsonDocument &doc)
     return result;
 }
 
+void util_file_version(const std::string &path, std::string &key, int64_t &mtime)
+{
+    const QFileInfo info(utf8_to_qt(path.c_str()));
+    auto canonical = info.canonicalFilePath();
+    if (canonical.isEmpty())
+        canonical = info.absoluteFilePath();
+    key = qt_to_utf8(canonical);
+    mtime = info.lastModified().toMSecsSinceEpoch();
+}
+
 bool util_write_json(const QString &path, const QJsonDocument &doc)
 {
     QFile file(path);
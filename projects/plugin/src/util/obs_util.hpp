@@ -20,6 +20,7 @@
 
 #include <QString>
 #include <QJsonDocument>
+#include <string>
 #include <vector>
 
 #ifndef M_PI
@@ -43,6 +44,10 @@ void util_format_path(QString &path);
 
 bool util_open_json(const QString &path, QJsonDocument &doc);
 
+/* Canonical path and modification time (ms since epoch) of a file,
+ * used by the caches to tell whether a file changed since it was loaded */
+void util_file_version(const std::string &path, std::string &key, int64_t &mtime);
+
 bool util_write_json(const QString &path, const QJsonDocument &doc);
 
 /* Get file path to /home/user/.config/*
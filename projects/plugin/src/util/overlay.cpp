@@ -19,26 +19,16 @@
 #include "overlay.hpp"
 #include "../sources/input_source.hpp"
 #include "config.hpp"
-#include "element/element.hpp"
-#include "element/element_analog_stick.hpp"
-#include "element/element_button.hpp"
-#include "element/element_dpad.hpp"
-#include "element/element_gamepad_id.hpp"
-#include "element/element_mouse_movement.hpp"
-#include "element/element_mouse_wheel.hpp"
-#include "element/element_trigger.hpp"
-#include "../gui/io_settings_dialog.hpp"
-#include "../hook/gamepad_hook_helper.hpp"
+#include "file_watcher.hpp"
+#include "layout_cache.hpp"
+#include "load_worker.hpp"
 #include "log.h"
-#include "../network/io_server.hpp"
-#include "../network/remote_connection.hpp"
 #include "obs_util.hpp"
-#include <QFile>
-#include <QJsonArray>
-#include <QJsonDocument>
+#include "texture_cache.hpp"
 #include <layout_constants.h>
 extern "C" {
 #include <graphics/image-file.h>
+#include <graphics/vec4.h>
 }
 
 namespace sources {
@@ -47,6 +37,7 @@ class overlay_settings;
 
 overlay::~overlay()
 {
+    watch_files("", "");
     unload();
 }
 
@@ -56,230 +47,270 @@ overlay::overlay(sources::overlay_settings *settings)
     m_is_loaded = load();
 }
 
-bool overlay::load()
+void overlay_files::load(const bool upload)
 {
-    unload();
-    const auto image_loaded = load_texture();
-    m_is_loaded = image_loaded && load_cfg();
-
-    if (!m_is_loaded) {
-        m_settings->gamepad = 0;
-        if (!image_loaded) {
-            m_settings->cx = 100; /* Default size */
-            m_settings->cy = 100;
+    std::string key;
+    util_file_version(image_file, key, image_mtime);
+    util_file_version(layout_file, key, layout_mtime);
+
+    if (!layout_file.empty())
+        layout = layout_cache::acquire(layout_file);
+
+    /* Atlases embedded in the layout replace the image file */
+    if (layout && layout->atlas) {
+        image = layout->atlas;
+        if (upload) {
+            obs_enter_graphics();
+            texture_cache::upload(image.get());
+            obs_leave_graphics();
         }
+    } else if (!image_file.empty()) {
+        image = texture_cache::acquire(image_file, upload);
+        if (!image)
+            bwarn("Error: failed to load texture %s", image_file.c_str());
     }
-
-    return m_is_loaded;
 }
 
-void overlay::unload()
+bool overlay::load()
 {
-    unload_texture();
-    unload_elements();
-    m_settings->cx = 100;
-    m_settings->cy = 100;
+    overlay_files files;
+    files.image_file = m_settings->image_file;
+    files.layout_file = m_settings->layout_file;
+    files.load(true);
+    return apply(files);
 }
 
-bool overlay::load_cfg()
+void overlay::load_async()
 {
-    if (!m_settings || m_settings->layout_file.empty())
-        return false;
-
-    QFile file(m_settings->layout_file.c_str());
+    load_async(m_settings->image_file, m_settings->layout_file, true);
+}
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        blog(LOG_ERROR, "[input-overlay] couldn't open config file");
-        return false;
+void overlay::load_async(const std::string &image_file, const std::string &layout_file, const bool replace)
+{
+    auto files = std::make_shared<overlay_files>();
+    files->image_file = image_file;
+    files->layout_file = layout_file;
+    files->reload = !replace;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        if (m_pending && !replace)
+            return;
+        m_pending = files;
     }
 
-    QJsonParseError err;
-    const auto cfg_doc = QJsonDocument::fromJson(file.readAll(), &err);
-    auto cfg_obj = cfg_doc.object();
-    const auto flag = true;
-
-    if (err.error == QJsonParseError::NoError) {
-        m_settings->cx = static_cast<uint32_t>(cfg_obj[CFG_TOTAL_WIDTH].toInt());
-        m_settings->cy = static_cast<uint32_t>(cfg_obj[CFG_TOTAL_HEIGHT].toInt());
-        m_settings->layout_flags = static_cast<uint8_t>(cfg_obj[CFG_FLAGS].toInt());
-
-        const auto debug_mode = cfg_obj[CFG_DEBUG_FLAG].toBool();
+    load_worker::post([files] {
+        /* Nothing left to do if a newer load replaced this one or the overlay is gone */
+        if (files.use_count() > 1)
+            files->load(false);
+        files->done = true;
+    });
+}
 
-#ifndef _DEBUG
-        if (debug_mode) {
-#else
-        {
-#endif
-            binfo("Started loading of %s", m_settings->layout_file.c_str());
-        }
+bool overlay::is_loading()
+{
+    std::lock_guard<std::mutex> lock(m_pending_mutex);
+    return m_pending != nullptr;
+}
 
-        auto arr = cfg_obj[CFG_ELEMENTS].toArray();
+void overlay::poll_load()
+{
+    /* Only reloaded if one of this overlay's files changed. The caches only load
+     * the files which changed, so an edited layout doesn't decode the image again.
+     * A load requested by the source always wins over this one */
+    const auto changes = file_watcher::changes();
+    if (changes != m_file_changes) {
+        m_file_changes = changes;
+        std::string key;
+        int64_t image_mtime, layout_mtime;
+        util_file_version(m_image_file, key, image_mtime);
+        util_file_version(m_layout_file, key, layout_mtime);
+        if (image_mtime != m_image_mtime || layout_mtime != m_layout_mtime)
+            load_async(m_image_file, m_layout_file, false);
+    }
 
-        for (const auto element : arr)
-            load_element(element.toObject(), debug_mode);
-    } else {
-        berr("Couldn't load layout from %s. Error: %s", m_settings->layout_file.c_str(), qt_to_utf8(err.errorString()));
+    std::shared_ptr<overlay_files> files;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        if (!m_pending || !m_pending->done)
+            return;
+        files.swap(m_pending);
     }
 
-    return flag;
+    /* The only part of loading which needs the graphics thread. All atlases
+     * decoded by now are uploaded together, so when a scene collection loads,
+     * the sources which finished in the meantime find their texture ready */
+    if (files->image) {
+        obs_enter_graphics();
+        texture_cache::upload_pending();
+        texture_cache::upload(files->image.get());
+        obs_leave_graphics();
+    }
+    apply(*files);
 }
 
-bool overlay::load_texture()
+bool overlay::apply(const overlay_files &files)
 {
-    if (!m_settings || m_settings->image_file.empty())
-        return false;
-
-    auto flag = true;
-
-    if (m_image == nullptr) {
-        m_image = new gs_image_file_t();
+    /* A file which is still being edited shouldn't take down a working overlay,
+     * it's reloaded again once it changes the next time */
+    if (files.reload && m_is_loaded && !(files.image && files.layout)) {
+        berr("Failed to reload %s, keeping the current overlay",
+             files.layout ? files.image_file.c_str() : files.layout_file.c_str());
+        m_image_mtime = files.image_mtime;
+        m_layout_mtime = files.layout_mtime;
+        return m_is_loaded;
     }
 
-    gs_image_file_init(m_image, m_settings->image_file.c_str());
+    const auto same_layout = files.layout_file == m_layout_file;
+    watch_files(files.image_file, files.layout_file);
+    m_image_mtime = files.image_mtime;
+    m_layout_mtime = files.layout_mtime;
 
-    obs_enter_graphics();
-    gs_image_file_init_texture(m_image);
-    obs_leave_graphics();
+    /* The new image and layout are acquired before the current ones are released,
+     * so reloading a source only loads the files which changed */
+    const auto old_layout = m_layout;
+    auto old_state = std::move(m_state);
+    unload();
+    m_image = files.image;
+    m_layout = files.layout;
+
+    if (m_layout && m_layout == old_layout) {
+        m_state = std::move(old_state);
+    } else if (m_layout && old_layout && same_layout) {
+        /* Same file, but edited. Elements which are still there keep their state */
+        const auto diff = m_layout->program.patch_state(old_layout->program, old_state, m_state);
+        binfo("Reloaded %s, %zu element(s) added, %zu removed, %zu changed", m_layout_file.c_str(), diff.added,
+              diff.removed, diff.changed);
+    }
 
-    if (!m_image->loaded) {
-        bwarn("Error: failed to load texture %s", m_settings->image_file.c_str());
-        flag = false;
-    } else {
+    if (m_image) {
         m_settings->cx = m_image->cx;
         m_settings->cy = m_image->cy;
     }
 
-    return flag;
+    if (m_layout) {
+        m_settings->cx = m_layout->cx;
+        m_settings->cy = m_layout->cy;
+        m_settings->layout_flags = m_layout->flags;
+    }
+
+    m_is_loaded = m_image && m_layout;
+    if (!m_is_loaded)
+        m_settings->gamepad = 0;
+    return m_is_loaded;
 }
 
-void overlay::unload_texture() const
+void overlay::watch_files(const std::string &image_file, const std::string &layout_file)
 {
+    /* New files are watched first, so files which are still used stay watched */
+    file_watcher::watch(image_file);
+    file_watcher::watch(layout_file);
+    file_watcher::unwatch(m_image_file);
+    file_watcher::unwatch(m_layout_file);
+    m_image_file = image_file;
+    m_layout_file = layout_file;
+}
+
+void overlay::unload()
+{
+    unload_texture();
+    unload_elements();
+    m_settings->cx = 100;
+    m_settings->cy = 100;
+}
+
+void overlay::unload_texture()
+{
+    m_image.reset();
     obs_enter_graphics();
-    gs_image_file_free(m_image);
+    gs_texrender_destroy(m_cache);
     obs_leave_graphics();
+    m_cache = nullptr;
+    m_cache_valid = false;
 }
 
 void overlay::unload_elements()
 {
-    m_elements.clear();
+    m_layout.reset();
+    m_state = {};
 }
 
 void overlay::draw(gs_effect_t *effect)
 {
     if (m_is_loaded) {
-        for (auto const &element : m_elements) {
-            element->draw(effect, m_image, m_settings);
+        /* Most frames nothing the layout reads changed and no press ran out,
+         * in which case only the cached image is drawn */
+        const auto now = obs_get_video_frame_time();
+        const auto hash = m_layout->program.input_hash(m_settings);
+        if (!m_cache_valid || hash != m_cache_hash || now >= m_state.redraw_at) {
+            m_batch.begin(m_image->texture);
+            m_layout->program.draw(&m_batch, m_settings, m_state);
+            m_cache_hash = hash;
+            render_cache(effect);
+        } else {
+            m_state.last_frame = now;
         }
-    }
-}
-
-void overlay::refresh_data()
-{
-    /* This copies over necessary input data information
-     * to make sure the overlay always has data available to
-     * draw the overlay. If the data was directly accessed in the render
-     * method, the overlay can start to flicker if the frame is rendered
-     * while the data is currently inaccessible, because it is being written
-     * to by the input thread, resulting in all buttons being unpressed
-     */
-    if (io_config::io_window_filters.input_blocked())
-        return;
-    input_data *source = nullptr;
-    std::lock_guard<std::mutex> lck1(local_data::data_mutex);
-    std::lock_guard<std::mutex> lck2(network::mutex);
 
-    if (uiohook::state || network::network_flag) {
-        if (network::server_instance && m_settings->selected_source > 0) {
-            source = network::server_instance->get_client(m_settings->selected_source - 1)->get_data();
+        if (m_cache_valid) {
+            gs_blend_state_push();
+            gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA); /* The cache is premultiplied */
+            auto *texture = gs_texrender_get_texture(m_cache);
+            gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture);
+            gs_draw_sprite(texture, 0, m_settings->cx, m_settings->cy);
+            gs_blend_state_pop();
         } else {
-            source = &local_data::data;
+            m_batch.draw(effect);
         }
-    }
 
-    if (source)
-        m_settings->data.copy(source);
-    if (m_settings->gamepad) {
-        libgamepad::hook_instance->get_mutex()->lock();
-        source->last_axis_event = *m_settings->gamepad->last_axis_event();
-        source->last_button_event = *m_settings->gamepad->last_button_event();
-        source->gamepad_axis = m_settings->gamepad->get_axis();
-        source->gamepad_buttons = m_settings->gamepad->get_buttons();
-        libgamepad::hook_instance->get_mutex()->unlock();
+        if (m_settings->mode == sources::IM_LIVE && m_settings->input)
+            m_settings->input->rendered();
     }
 }
 
-void overlay::load_element(const QJsonObject &obj, const bool debug)
+void overlay::render_cache(gs_effect_t *effect)
 {
-    const auto type = obj[CFG_TYPE].toInt();
-    element *new_element = nullptr;
-
-    switch (type) {
-    case ET_TEXTURE:
-        new_element = new element_texture;
-        break;
-    case ET_GAMEPAD_ID:
-        new_element = new element_gamepad_id;
-        break;
-    case ET_BUTTON:
-        new_element = new element_button;
-        break;
-    case ET_WHEEL:
-        new_element = new element_wheel;
-        break;
-    case ET_TRIGGER:
-        new_element = new element_trigger;
-        break;
-    case ET_ANALOG_STICK:
-        new_element = new element_analog_stick;
-        break;
-    case ET_DPAD_STICK:
-        new_element = new element_dpad;
-        break;
-    case ET_MOUSE_STATS:
-        new_element = new element_mouse_movement;
-        break;
-    default:
-        if (debug) {
-            binfo("Invalid element type %i for %s", type, qt_to_utf8(obj[CFG_ID].toString()));
-        }
-    }
+    m_cache_valid = false;
+    if (!m_cache)
+        m_cache = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
 
-    if (new_element) {
-        new_element->load(obj);
-        m_elements.emplace_back(new_element);
-
-#ifndef _DEBUG
-        if (debug) {
-#else
-        {
-#endif
-            binfo("Type: %14s, KEYCODE: 0x%04X ID: %s", element_type_to_string(static_cast<element_type>(type)),
-                  new_element->get_keycode(), qt_to_utf8(obj[CFG_ID].toString()));
-        }
-    }
+    gs_texrender_reset(m_cache);
+    if (!m_cache || !gs_texrender_begin(m_cache, m_settings->cx, m_settings->cy))
+        return;
+
+    vec4 clear_color;
+    vec4_zero(&clear_color);
+    gs_clear(GS_CLEAR_COLOR, &clear_color, 0.f, 0);
+    gs_ortho(0.f, float(m_settings->cx), 0.f, float(m_settings->cy), -100.f, 100.f);
+
+    /* Sprites overlap (e.g. triggers), so the alpha channel has to be blended separately */
+    gs_blend_state_push();
+    gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+    m_batch.draw(effect);
+    gs_blend_state_pop();
+
+    gs_texrender_end(m_cache);
+    m_cache_valid = true;
 }
 
-const char *overlay::element_type_to_string(const element_type t)
+void overlay::refresh_data()
 {
-    switch (t) {
-    case ET_TEXTURE:
-        return "Texture";
-    case ET_BUTTON:
-        return "Button";
-    case ET_ANALOG_STICK:
-        return "Analog stick";
-    case ET_WHEEL:
-        return "Scroll wheel";
-    case ET_MOUSE_STATS:
-        return "Mouse movement";
-    case ET_TRIGGER:
-        return "Trigger";
-    case ET_GAMEPAD_ID:
-        return "Gamepad ID";
-    case ET_DPAD_STICK:
-        return "DPad";
-    default:
-    case ET_INVALID:
-        return "Invalid";
+    /* Replays are owned by the source, so they aren't shared */
+    if (m_settings->mode == sources::IM_REPLAY) {
+        m_settings->replay.tick(obs_get_video_frame_time());
+        m_settings->data = &m_settings->replay.data();
+        return;
     }
+
+    /* This makes sure the overlay has a stable copy of the
+     * input data to draw from. If the data was directly accessed in the render
+     * method, the overlay can start to flicker if the frame is rendered
+     * while the data is currently being written to by the input thread.
+     * The copy is shared with all other sources using the same input and
+     * only refreshed by whichever of them ticks first each frame
+     */
+    auto &input = m_settings->input;
+    if (!input || input->origin() != m_settings->selected_source || input->pad() != m_settings->gamepad.get())
+        input = input_snapshots::acquire(m_settings->selected_source, m_settings->gamepad);
+
+    input->refresh(obs_get_video_frame_time());
+    m_settings->data = &input->data();
 }
@@ -23,40 +23,86 @@
 #endif
 
 #include "../hook/uiohook_helper.hpp"
-#include "element/element.hpp"
+#include "layout_cache.hpp"
+#include "sprite_batch.hpp"
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 class ccl_config;
 
 typedef struct gs_image_file gs_image_file_t;
 
+/* Image and layout of an overlay. Loading only touches the caches, so it can
+ * run on the load worker, in which case the result is handed over to the
+ * video thread once done */
+struct overlay_files {
+    std::string image_file, layout_file;
+    std::shared_ptr<gs_image_file_t> image;
+    std::shared_ptr<const compiled_layout> layout;
+    int64_t image_mtime = 0, layout_mtime = 0; /* When loading started */
+    bool reload = false; /* Started because the files changed on disk */
+    std::atomic<bool> done{false};
+
+    /* Without upload the image has no texture yet, see texture_cache::acquire */
+    void load(bool upload);
+};
+
 class overlay {
 public:
     overlay() = default;
     ~overlay();
     explicit overlay(sources::overlay_settings *settings);
+    /* Loads the files of the current settings right away */
     bool load();
+
+    /* Loads the files of the current settings on the load worker, the overlay
+     * keeps drawing the current files until poll_load() swaps in the new ones */
+    void load_async();
+
+    /* Applies a finished load_async() and reloads files which were
+     * changed on disk, video thread only */
+    void poll_load();
+
+    /* Whether a load_async() hasn't been applied yet */
+    bool is_loading();
+
     void unload();
     void draw(gs_effect_t *effect);
     void refresh_data();
     bool is_loaded() const { return m_is_loaded; }
-    gs_image_file_t *get_texture() const { return m_image; }
+    /* Input backends the layout reads from, see backends.hpp */
+    uint8_t backends() const { return m_layout ? m_layout->program.backends() : 0; }
+    gs_image_file_t *get_texture() const { return m_image.get(); }
 
 private:
-    bool load_cfg();
-    bool load_texture();
-    void unload_texture() const;
+    /* Without replace nothing happens if there already is a load pending */
+    void load_async(const std::string &image_file, const std::string &layout_file, bool replace);
+    bool apply(const overlay_files &files);
+    void watch_files(const std::string &image_file, const std::string &layout_file);
+    void unload_texture();
     void unload_elements();
-    void load_element(const QJsonObject &obj, bool debug);
-
-    static const char *element_type_to_string(element_type t);
+    void render_cache(gs_effect_t *effect);
 
-    gs_image_file_t *m_image = nullptr;
+    std::shared_ptr<gs_image_file_t> m_image; /* Shared with other overlays using the same file */
     sources::overlay_settings *m_settings = nullptr;
     bool m_is_loaded = false;
-    std::vector<std::unique_ptr<element>> m_elements;
+    std::shared_ptr<const compiled_layout> m_layout; /* Shared with other overlays using the same file */
+    render_state m_state;
+    std::shared_ptr<overlay_files> m_pending; /* Newest load_async() */
+    std::mutex m_pending_mutex;
+    /* Files in use, watched for changes */
+    std::string m_image_file, m_layout_file;
+    int64_t m_image_mtime = 0, m_layout_mtime = 0;
+    uint32_t m_file_changes = 0; /* file_watcher::changes() when last checked */
+    sprite_batch m_batch; /* All elements are drawn in one go */
+    /* Last drawn image, only redrawn when the input it shows changed */
+    gs_texrender_t *m_cache = nullptr;
+    uint64_t m_cache_hash = 0; /* render_program::input_hash() of the cached image */
+    bool m_cache_valid = false;
     uint16_t m_track_radius{};
     uint16_t m_max_mouse_movement{};
     float m_arrow_rot = 0.f;
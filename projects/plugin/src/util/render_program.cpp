@@ -0,0 +1,535 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "render_program.hpp"
+#include "log.h"
+#include "obs_util.hpp"
+#include "sprite_batch.hpp"
+#include "../hook/gamepad_hook_helper.hpp"
+#include "../sources/input_source.hpp"
+#include <QJsonArray>
+#include <algorithm>
+#include <keycodes.h>
+#include <libgamepad.hpp>
+#include <numeric>
+#include <string.h>
+#include <unordered_map>
+#include <util.hpp>
+
+void render_program::clear()
+{
+    m_ops.clear();
+    m_z_levels.clear();
+    m_positions.clear();
+    m_mappings.clear();
+    m_pressed.clear();
+    m_keys.clear();
+    m_mouse_buttons.clear();
+    m_pad_buttons.clear();
+    m_axes_x.clear();
+    m_axes_y.clear();
+    m_params.clear();
+    m_min_visible.clear();
+    m_ids.clear();
+    m_backends = 0;
+    m_key_mask.reset();
+    m_mouse_mask.reset();
+    m_pad_mask.reset();
+    m_axis_mask.reset();
+    m_reads = 0;
+}
+
+bool render_program::add(const QJsonObject &obj, const bool debug)
+{
+    const auto map = obj[CFG_MAPPING].toArray();
+    const auto pos = obj[CFG_POS].toArray();
+    io_layout_element e{};
+
+    /* Same as io-cct does when exporting */
+    strncpy(e.id, qt_to_utf8(obj[CFG_ID].toString()), IO_LAYOUT_ID_LENGTH - 1);
+    e.type = obj[CFG_TYPE].toInt();
+    e.code = obj[CFG_KEY_CODE].toInt();
+    e.pos[0] = pos[0].toInt();
+    e.pos[1] = pos[1].toInt();
+    for (int i = 0; i < 4; i++)
+        e.mapping[i] = map[i].toInt();
+    e.z_level = obj[CFG_Z_LEVEL].toInt();
+    e.side = obj[CFG_SIDE].toInt();
+    e.direction = obj[CFG_DIRECTION].toInt();
+    e.radius = obj[e.type == ET_MOUSE_STATS ? CFG_MOUSE_RADIUS : CFG_STICK_RADIUS].toInt();
+    e.min_visible = obj[CFG_MIN_VISIBLE].toInt(-1);
+    e.mouse_type = uint8_t(obj[CFG_MOUSE_TYPE].toBool());
+    e.trigger_mode = uint8_t(obj[CFG_TRIGGER_MODE].toBool());
+    return add(e, debug);
+}
+
+bool render_program::add(const io_layout_element &e, const bool debug)
+{
+    const auto type = e.type;
+    const gs_rect mapping = {e.mapping[0], e.mapping[1], e.mapping[2], e.mapping[3]};
+
+    /* Most elements have their pressed texture right below the default one */
+    auto pressed = mapping;
+    pressed.y = mapping.y + mapping.cy + CFG_INNER_BORDER;
+
+    auto op = OP_TEXTURE;
+    uint16_t key = IO_KEY_INVALID;
+    uint8_t mouse_button = PROGRAM_NO_BUTTON, pad_button = PROGRAM_NO_BUTTON;
+    uint8_t axis_x = 0, axis_y = 0, param = 0;
+    const auto side = static_cast<element_side>(e.side);
+    const auto left = side == element_side::LEFT;
+
+    switch (type) {
+    case ET_TEXTURE:
+        break;
+    case ET_BUTTON: {
+        /* Layouts don't say whether a code is a key, mouse or gamepad button,
+         * so all three are looked up, as before */
+        const auto code = static_cast<uint16_t>(e.code);
+        op = OP_BUTTON;
+        key = input_data::key_index(code);
+        if (input_data::is_mouse_code(code) && (code & 0xff) < IO_MOUSE_BUTTON_COUNT)
+            mouse_button = uint8_t(code & 0xff);
+        if (code < IO_PAD_BUTTON_COUNT)
+            pad_button = uint8_t(code);
+        break;
+    }
+    case ET_WHEEL:
+        op = OP_WHEEL;
+        break;
+    case ET_MOUSE_STATS:
+        op = e.mouse_type ? OP_MOUSE_DOT : OP_MOUSE_ARROW;
+        param = static_cast<uint8_t>(e.radius);
+        break;
+    case ET_ANALOG_STICK:
+        op = OP_ANALOG_STICK;
+        axis_x = left ? gamepad::axis::LEFT_STICK_X : gamepad::axis::RIGHT_STICK_X;
+        axis_y = left ? gamepad::axis::LEFT_STICK_Y : gamepad::axis::RIGHT_STICK_Y;
+        pad_button = left ? gamepad::button::L_THUMB : gamepad::button::R_THUMB;
+        param = static_cast<uint8_t>(e.radius);
+        break;
+    case ET_TRIGGER:
+        op = e.trigger_mode ? OP_TRIGGER_BUTTON : OP_TRIGGER;
+        /* Triggers without a side never move */
+        axis_x = left ? gamepad::axis::LEFT_TRIGGER : gamepad::axis::RIGHT_TRIGGER;
+        if (side == element_side::INVALID)
+            axis_x = PROGRAM_NO_AXIS;
+        param = static_cast<uint8_t>(e.direction);
+        break;
+    case ET_GAMEPAD_ID:
+        op = OP_GAMEPAD_ID;
+        pad_button = gamepad::button::GUIDE;
+        break;
+    case ET_DPAD_STICK:
+        op = OP_DPAD;
+        break;
+    default:
+        if (debug)
+            binfo("Invalid element type %i for %s", type, e.id);
+        return false;
+    }
+
+    m_ops.emplace_back(op);
+    m_z_levels.emplace_back(static_cast<uint8_t>(e.z_level));
+    m_positions.push_back({float(e.pos[0]), float(e.pos[1])});
+    m_mappings.emplace_back(mapping);
+    m_pressed.emplace_back(pressed);
+    m_keys.emplace_back(key);
+    m_mouse_buttons.emplace_back(mouse_button);
+    m_pad_buttons.emplace_back(pad_button);
+    m_axes_x.emplace_back(axis_x);
+    m_axes_y.emplace_back(axis_y);
+    m_params.emplace_back(param);
+    m_min_visible.emplace_back(static_cast<int16_t>(e.min_visible));
+    m_ids.emplace_back(std::string(e.id, strnlen(e.id, IO_LAYOUT_ID_LENGTH)));
+    return true;
+}
+
+template<class T> static void apply_order(std::vector<T> &v, const std::vector<size_t> &order)
+{
+    std::vector<T> sorted;
+    sorted.reserve(v.size());
+    for (const auto i : order)
+        sorted.emplace_back(v[i]);
+    v.swap(sorted);
+}
+
+void render_program::reorder(const std::vector<size_t> &order)
+{
+    apply_order(m_ops, order);
+    apply_order(m_z_levels, order);
+    apply_order(m_positions, order);
+    apply_order(m_mappings, order);
+    apply_order(m_pressed, order);
+    apply_order(m_keys, order);
+    apply_order(m_mouse_buttons, order);
+    apply_order(m_pad_buttons, order);
+    apply_order(m_axes_x, order);
+    apply_order(m_axes_y, order);
+    apply_order(m_params, order);
+    apply_order(m_min_visible, order);
+    apply_order(m_ids, order);
+}
+
+void render_program::finish(const uint8_t layout_flags)
+{
+    /* Stable, so elements on the same level keep the order of the layout file,
+     * which only matters for elements of the same op overlapping each other */
+    std::vector<size_t> order(m_ops.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        if (m_z_levels[a] != m_z_levels[b])
+            return m_z_levels[a] < m_z_levels[b];
+        return m_ops[a] < m_ops[b];
+    });
+    reorder(order);
+
+    /* Low key codes (Esc, digits, most letters) overlap with the gamepad button range,
+     * so only layouts flagged as gamepad layouts use the gamepad hook. Elements
+     * still read all three tables when drawing, as before */
+    const auto gamepad = (layout_flags & OF_GAMEPAD) != 0;
+    m_backends = 0;
+    for (size_t i = 0; i < m_ops.size(); i++) {
+        switch (m_ops[i]) {
+        case OP_TEXTURE:
+            break;
+        case OP_BUTTON:
+            if (gamepad && m_pad_buttons[i] != PROGRAM_NO_BUTTON)
+                m_backends |= BACKEND_GAMEPAD;
+            else if (m_keys[i] != IO_KEY_INVALID || m_mouse_buttons[i] != PROGRAM_NO_BUTTON)
+                m_backends |= BACKEND_UIOHOOK;
+            break;
+        case OP_WHEEL:
+        case OP_MOUSE_ARROW:
+        case OP_MOUSE_DOT:
+            m_backends |= BACKEND_UIOHOOK;
+            break;
+        default:
+            if (gamepad)
+                m_backends |= BACKEND_GAMEPAD;
+        }
+    }
+
+    for (size_t i = 0; i < m_ops.size(); i++) {
+        switch (m_ops[i]) {
+        case OP_BUTTON:
+            if (m_keys[i] != IO_KEY_INVALID)
+                m_key_mask.set(m_keys[i]);
+            if (m_mouse_buttons[i] != PROGRAM_NO_BUTTON)
+                m_mouse_mask.set(m_mouse_buttons[i]);
+            if (m_pad_buttons[i] != PROGRAM_NO_BUTTON)
+                m_pad_mask.set(m_pad_buttons[i]);
+            m_reads |= READS_MIN_VISIBLE;
+            break;
+        case OP_WHEEL:
+            m_mouse_mask.set(VC_MOUSE_WHEEL & 0xff);
+            m_reads |= READS_WHEEL;
+            break;
+        case OP_MOUSE_ARROW:
+        case OP_MOUSE_DOT:
+            m_reads |= READS_MOUSE_MOVEMENT;
+            break;
+        case OP_ANALOG_STICK:
+            m_axis_mask.set(m_axes_y[i]);
+            m_pad_mask.set(m_pad_buttons[i]);
+            /* fallthrough */
+        case OP_TRIGGER:
+        case OP_TRIGGER_BUTTON:
+            if (m_axes_x[i] < IO_PAD_AXIS_COUNT)
+                m_axis_mask.set(m_axes_x[i]);
+            break;
+        case OP_GAMEPAD_ID:
+            m_pad_mask.set(m_pad_buttons[i]);
+            m_reads |= READS_GAMEPAD_ID;
+            break;
+        case OP_DPAD:
+            m_pad_mask.set(gamepad::button::DPAD_UP);
+            m_pad_mask.set(gamepad::button::DPAD_DOWN);
+            m_pad_mask.set(gamepad::button::DPAD_LEFT);
+            m_pad_mask.set(gamepad::button::DPAD_RIGHT);
+            break;
+        default:;
+        }
+    }
+}
+
+program_diff render_program::patch_state(const render_program &old, const render_state &old_state,
+                                         render_state &state) const
+{
+    program_diff diff;
+    std::unordered_map<std::string, size_t> old_index;
+    for (size_t i = 0; i < old.m_ids.size(); i++)
+        old_index.emplace(old.m_ids[i], i);
+
+    state.visible_until.assign(m_ops.size(), 0);
+    state.angles.assign(m_ops.size(), 0.f);
+    state.pressed.assign(m_ops.size(), 0);
+    state.last_frame = old_state.last_frame;
+
+    for (size_t i = 0; i < m_ops.size(); i++) {
+        const auto it = old_index.find(m_ids[i]);
+        if (it == old_index.end()) {
+            diff.added++;
+            continue;
+        }
+
+        const auto j = it->second;
+        old_index.erase(it);
+        if (j < old_state.angles.size()) {
+            state.visible_until[i] = old_state.visible_until[j];
+            state.angles[i] = old_state.angles[j];
+            state.pressed[i] = old_state.pressed[j];
+        }
+
+        if (old.m_ops[j] != m_ops[i] || old.m_z_levels[j] != m_z_levels[i] ||
+            memcmp(&old.m_positions[j], &m_positions[i], sizeof(vec2)) != 0 ||
+            memcmp(&old.m_mappings[j], &m_mappings[i], sizeof(gs_rect)) != 0)
+            diff.changed++;
+    }
+
+    diff.removed = old_index.size();
+    return diff;
+}
+
+/* Straight directions have textures, but as before only the diagonals are shown */
+static int dpad_texture(const input_data &data)
+{
+    const auto left = data.gamepad_button_state(gamepad::button::DPAD_LEFT);
+    const auto right = data.gamepad_button_state(gamepad::button::DPAD_RIGHT);
+
+    if (data.gamepad_button_state(gamepad::button::DPAD_UP)) {
+        if (left)
+            return DT_TOP_LEFT;
+        if (right)
+            return DT_TOP_RIGHT;
+    } else if (data.gamepad_button_state(gamepad::button::DPAD_DOWN)) {
+        if (left)
+            return DT_BOTTOM_LEFT;
+        if (right)
+            return DT_BOTTOM_RIGHT;
+    }
+    return DT_CENTER;
+}
+
+/* Mouse movement relative to the monitor center or, without one, the screen origin */
+static void mouse_delta(const sources::overlay_settings *settings, int &d_x, int &d_y)
+{
+    d_x = settings->data->last_mouse_movement.x;
+    d_y = settings->data->last_mouse_movement.y;
+    if (settings->use_center) {
+        d_x -= settings->monitor_h;
+        d_y -= settings->monitor_w;
+    }
+}
+
+void render_program::draw(sprite_batch *batch, sources::overlay_settings *settings, render_state &state) const
+{
+    const auto &data = *settings->data;
+    const auto now = obs_get_video_frame_time();
+
+    if (state.angles.size() != m_ops.size()) {
+        state.visible_until.assign(m_ops.size(), 0);
+        state.angles.assign(m_ops.size(), 0.f);
+        state.pressed.assign(m_ops.size(), 0);
+    }
+    state.redraw_at = UINT64_MAX;
+
+    for (size_t i = 0; i < m_ops.size(); i++) {
+        const auto &mapping = m_mappings[i];
+        const auto &pos = m_positions[i];
+
+        switch (m_ops[i]) {
+        case OP_TEXTURE:
+            batch->add(&mapping, &pos);
+            break;
+        case OP_BUTTON: {
+            const auto pad = m_pad_buttons[i], mouse = m_mouse_buttons[i];
+            const auto pressed = (pad != PROGRAM_NO_BUTTON && data.gamepad_buttons.test(pad)) ||
+                                 (m_keys[i] != IO_KEY_INVALID && data.keyboard.test(m_keys[i])) ||
+                                 (mouse != PROGRAM_NO_BUTTON && data.mouse.test(mouse));
+            const auto min_visible = m_min_visible[i] < 0 ? settings->min_visible_ms : m_min_visible[i];
+            if (pressed) {
+                state.visible_until[i] = now + min_visible * 1000000ull;
+            } else if (state.pressed[i]) {
+                /* Frames in between might not have been drawn, the press
+                 * was still there in the one before this one */
+                state.visible_until[i] = state.last_frame + min_visible * 1000000ull;
+            }
+            state.pressed[i] = pressed;
+
+            const auto visible = pressed || now < state.visible_until[i];
+            if (visible && !pressed)
+                state.redraw_at = std::min(state.redraw_at, state.visible_until[i]);
+            batch->add(visible ? &m_pressed[i] : &mapping, &pos);
+            break;
+        }
+        case OP_WHEEL: {
+            /* Middle button, then the scroll direction and the wheel itself on top */
+            if (data.mouse_state(VC_MOUSE_WHEEL)) {
+                const auto middle = neighbour(mapping, 1);
+                batch->add(&middle, &pos);
+            }
+            if (data.last_wheel_event.rotation == WHEEL_UP || data.last_wheel_event.rotation == WHEEL_DOWN) {
+                const auto direction = neighbour(mapping, data.last_wheel_event.rotation == WHEEL_UP ? 2 : 3);
+                batch->add(&direction, &pos);
+            }
+            batch->add(&mapping, &pos);
+            break;
+        }
+        case OP_MOUSE_ARROW: {
+            int d_x, d_y;
+            mouse_delta(settings, d_x, d_y);
+            /* Movements below the dead zone keep the old angle */
+            if (abs(d_x) >= settings->mouse_deadzone && abs(d_y) >= settings->mouse_deadzone)
+                state.angles[i] = float(0.5 * M_PI) + atan2f(float(d_y), float(d_x));
+            batch->add(&mapping, &pos, state.angles[i]);
+            break;
+        }
+        case OP_MOUSE_DOT: {
+            int d_x, d_y;
+            mouse_delta(settings, d_x, d_y);
+            if (!settings->use_center) {
+                if (abs(d_x) < settings->mouse_deadzone)
+                    d_x = 0;
+                if (abs(d_y) < settings->mouse_deadzone)
+                    d_y = 0;
+            }
+            const auto factor_x = UTIL_CLAMP(-1, ((double)d_x / settings->mouse_sens), 1);
+            const auto factor_y = UTIL_CLAMP(-1, ((double)d_y / settings->mouse_sens), 1);
+            const vec2 dot = {float(pos.x + m_params[i] * factor_x), float(pos.y + m_params[i] * factor_y)};
+            batch->add(&mapping, &dot);
+            break;
+        }
+        case OP_ANALOG_STICK: {
+            const auto radius = m_params[i] * 2;
+            vec2 stick = pos;
+            stick.x += (data.gamepad_axis_state(m_axes_x[i]) - 0.5) * radius;
+            stick.y += (data.gamepad_axis_state(m_axes_y[i]) - 0.5) * radius;
+            batch->add(data.gamepad_button_state(m_pad_buttons[i]) ? &m_pressed[i] : &mapping, &stick);
+            break;
+        }
+        case OP_TRIGGER_BUTTON:
+            batch->add(data.gamepad_axis_state(m_axes_x[i]) >= 0.1f ? &m_pressed[i] : &mapping, &pos);
+            break;
+        case OP_TRIGGER: {
+            /* Unpressed first, then the pressed texture cut off at the current progress */
+            const auto progress = data.gamepad_axis_state(m_axes_x[i]);
+            auto crop = m_pressed[i];
+            auto crop_pos = pos;
+
+            switch (m_params[i]) {
+            case DIR_UP:
+                crop.cy = static_cast<int>(mapping.cy * progress);
+                crop.y = m_pressed[i].y + (mapping.cy - crop.cy);
+                crop_pos.y += mapping.cy - crop.cy;
+                break;
+            case DIR_DOWN:
+                crop.cy = static_cast<int>(mapping.cy * progress);
+                break;
+            case DIR_LEFT:
+                crop.cx = static_cast<int>(mapping.cx * progress);
+                crop.x = mapping.x + (mapping.cx - crop.cx);
+                crop_pos.x += mapping.cx - crop.cx;
+                break;
+            case DIR_RIGHT:
+                crop.cx = static_cast<int>(mapping.cx * progress);
+                break;
+            default:;
+            }
+
+            batch->add(&mapping, &pos);
+            batch->add(&crop, &crop_pos);
+            break;
+        }
+        case OP_GAMEPAD_ID: {
+            /* Player 2 - 4 are next to the default texture (player 1), followed by the pressed texture */
+            if (data.gamepad_button_state(m_pad_buttons[i])) {
+                const auto guide = neighbour(mapping, 4);
+                batch->add(&guide, &pos);
+            }
+
+            if (settings->gamepad) {
+                libgamepad::hook_instance->get_mutex()->lock();
+                if (settings->gamepad->is_valid() > 0) {
+                    const auto index = settings->gamepad->get_index() < 4 ? settings->gamepad->get_index() : 0;
+                    const auto player = neighbour(mapping, index + 1);
+                    batch->add(&player, &pos);
+                }
+                libgamepad::hook_instance->get_mutex()->unlock();
+            }
+            break;
+        }
+        case OP_DPAD: {
+            const auto texture = dpad_texture(data);
+            if (texture == DT_CENTER) {
+                batch->add(&mapping, &pos);
+            } else {
+                const auto direction = neighbour(mapping, texture);
+                batch->add(&direction, &pos);
+            }
+            break;
+        }
+        default:;
+        }
+    }
+    state.last_frame = now;
+}
+
+uint64_t render_program::input_hash(const sources::overlay_settings *settings) const
+{
+    const auto &data = *settings->data;
+    auto hash = PROGRAM_HASH_BASIS;
+    const auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * PROGRAM_HASH_PRIME; };
+
+    /* Not read by draw(), but it's the size of the image the overlay caches */
+    mix(settings->cx);
+    mix(settings->cy);
+
+    if (m_key_mask.any())
+        mix(std::hash<std::bitset<IO_KEY_COUNT>>{}(data.keyboard & m_key_mask));
+    mix((data.mouse & m_mouse_mask).to_ulong());
+    mix((data.gamepad_buttons & m_pad_mask).to_ulong());
+
+    for (size_t i = 0; i < IO_PAD_AXIS_COUNT; i++) {
+        if (m_axis_mask.test(i)) {
+            uint32_t bits;
+            memcpy(&bits, &data.gamepad_axis[i], sizeof(bits));
+            mix(bits);
+        }
+    }
+
+    if (m_reads & READS_WHEEL)
+        mix(uint16_t(data.last_wheel_event.rotation));
+
+    if (m_reads & READS_MOUSE_MOVEMENT) {
+        mix(uint16_t(data.last_mouse_movement.x) | uint32_t(uint16_t(data.last_mouse_movement.y)) << 16);
+        mix(settings->use_center);
+        mix(settings->monitor_w | uint64_t(settings->monitor_h) << 32);
+        mix(settings->mouse_deadzone | uint32_t(settings->mouse_sens) << 8);
+    }
+
+    if (m_reads & READS_MIN_VISIBLE)
+        mix(settings->min_visible_ms);
+
+    if ((m_reads & READS_GAMEPAD_ID) && settings->gamepad) {
+        libgamepad::hook_instance->get_mutex()->lock();
+        mix(uint64_t(settings->gamepad->is_valid()) << 32 | uint32_t(settings->gamepad->get_index()));
+        libgamepad::hook_instance->get_mutex()->unlock();
+    }
+    return hash;
+}
@@ -0,0 +1,155 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include "../hook/backends.hpp"
+#include "input_data.hpp"
+#include <graphics/graphics.h>
+#include <graphics/vec2.h>
+#include <iolayout.h>
+#include <layout_constants.h>
+#include <QJsonObject>
+#include <bitset>
+#include <string>
+#include <vector>
+
+class sprite_batch;
+
+namespace sources {
+class overlay_settings;
+}
+
+/* What a compiled element does each frame, one per element type
+ * (or per mode, for elements which behave completely different) */
+enum program_op : uint8_t {
+    OP_TEXTURE,
+    OP_BUTTON,
+    OP_WHEEL,
+    OP_MOUSE_ARROW,
+    OP_MOUSE_DOT,
+    OP_ANALOG_STICK,
+    OP_TRIGGER,
+    OP_TRIGGER_BUTTON,
+    OP_GAMEPAD_ID,
+    OP_DPAD
+};
+
+#define PROGRAM_NO_BUTTON 0xFF
+#define PROGRAM_NO_AXIS 0xFF /* Always reads as 0 */
+
+/* FNV-1a, over whole values instead of bytes */
+#define PROGRAM_HASH_BASIS 0xcbf29ce484222325ull
+#define PROGRAM_HASH_PRIME 0x100000001b3ull
+
+/* Input which isn't covered by the key, button and axis masks of a program */
+enum program_reads : uint8_t {
+    READS_WHEEL = 1 << 0,
+    READS_MOUSE_MOVEMENT = 1 << 1,
+    READS_MIN_VISIBLE = 1 << 2,
+    READS_GAMEPAD_ID = 1 << 3
+};
+
+/* What an overlay remembers between frames for each element of its program.
+ * Kept apart from the program, which is shared by all overlays using the same layout */
+struct render_state {
+    std::vector<uint64_t> visible_until; /* Frame time until which a press is still shown   */
+    std::vector<float> angles;           /* Last mouse arrow angle                          */
+    std::vector<uint8_t> pressed;        /* Whether a button was pressed when last drawn    */
+    uint64_t last_frame = 0;             /* Frame time of the last frame, drawn or not      */
+    uint64_t redraw_at = UINT64_MAX;     /* Frame time at which the next shown press ends   */
+};
+
+/* What changed between two versions of a layout, elements are matched by id */
+struct program_diff {
+    size_t added = 0, removed = 0, changed = 0;
+};
+
+/* A layout compiled into flat arrays, one entry per element.
+ * Entries are sorted by z level (lowest first, like cct draws them) and then
+ * by op, so the draw loop runs over the same code paths back to back.
+ * Everything that can be worked out from the layout alone (key indices,
+ * pressed texture rects, axes) is done once when compiling. Once finished
+ * a program is never modified, per overlay state lives in render_state */
+class render_program {
+public:
+    void clear();
+
+    /* Adds an element, false if its type is invalid. Call finish() once all are added */
+    bool add(const io_layout_element &e, bool debug);
+
+    /* Same for an element from a json layout */
+    bool add(const QJsonObject &obj, bool debug);
+
+    /* Sorts the elements by z level and op. layout_flags (see overlay_flag)
+     * decide whether button codes are gamepad buttons or keys */
+    void finish(uint8_t layout_flags);
+
+    /* Adds the sprites of all elements for the current input to the batch, video thread only */
+    void draw(sprite_batch *batch, sources::overlay_settings *settings, render_state &state) const;
+
+    /* Hash of all input data and settings draw() reads. As long as it stays the same
+     * and no press runs out (render_state::redraw_at), draw() adds the same sprites */
+    uint64_t input_hash(const sources::overlay_settings *settings) const;
+
+    /* Carries the state of elements which are still in this program over from an
+     * older version of the same layout, so a reloaded layout doesn't reset them */
+    program_diff patch_state(const render_program &old, const render_state &old_state, render_state &state) const;
+
+    size_t size() const { return m_ops.size(); }
+    bool empty() const { return m_ops.empty(); }
+
+    /* Input backends the elements read from, see backends.hpp */
+    uint8_t backends() const { return m_backends; }
+
+private:
+    /* Texture rects which aren't stored (e.g. the eight dpad directions)
+     * are placed next to the default one in the layout texture */
+    static gs_rect neighbour(const gs_rect &rect, int n)
+    {
+        auto result = rect;
+        result.x += n * (rect.cx + CFG_INNER_BORDER);
+        return result;
+    }
+
+    void reorder(const std::vector<size_t> &order);
+
+    /* clang-format off */
+    std::vector<uint8_t> m_ops;              /* See program_op                                      */
+    std::vector<uint8_t> m_z_levels;
+    std::vector<vec2> m_positions;
+    std::vector<gs_rect> m_mappings;         /* Default texture rect                               */
+    std::vector<gs_rect> m_pressed;          /* Pressed texture rect (buttons, triggers, sticks)   */
+    std::vector<uint16_t> m_keys;            /* Index into input_data::keyboard or IO_KEY_INVALID  */
+    std::vector<uint8_t> m_mouse_buttons;    /* Index into input_data::mouse or PROGRAM_NO_BUTTON  */
+    std::vector<uint8_t> m_pad_buttons;      /* Gamepad button or PROGRAM_NO_BUTTON                */
+    std::vector<uint8_t> m_axes_x;           /* Trigger axis or stick x axis                       */
+    std::vector<uint8_t> m_axes_y;           /* Stick y axis                                       */
+    std::vector<uint8_t> m_params;           /* Trigger direction, stick/mouse radius              */
+    std::vector<int16_t> m_min_visible;      /* Per button minimum press time, -1 = source setting */
+    std::vector<std::string> m_ids;          /* Only used to compare layout versions               */
+    /* clang-format on */
+    uint8_t m_backends = 0;
+
+    /* Everything the elements read from input_data, see input_hash() */
+    std::bitset<IO_KEY_COUNT> m_key_mask;
+    std::bitset<IO_MOUSE_BUTTON_COUNT> m_mouse_mask;
+    std::bitset<IO_PAD_BUTTON_COUNT> m_pad_mask;
+    std::bitset<IO_PAD_AXIS_COUNT> m_axis_mask;
+    uint8_t m_reads = 0; /* See program_reads */
+};
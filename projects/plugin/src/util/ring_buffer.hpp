@@ -0,0 +1,87 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Fixed size byte ring, used to keep received data until it forms complete
+ * messages. Not thread safe, each instance belongs to one thread */
+template<size_t N> class ring_buffer {
+    static_assert(N && (N & (N - 1)) == 0, "ring_buffer size must be a power of two");
+
+    uint8_t m_data[N];
+    size_t m_head = 0; /* Total bytes consumed */
+    size_t m_tail = 0; /* Total bytes written */
+
+public:
+    size_t size() const { return m_tail - m_head; }
+    size_t space() const { return N - size(); }
+
+    void clear() { m_head = m_tail = 0; }
+
+    /* Free space that can be written to directly (e.g. by recv()), which
+     * might be less than space() if it wraps around. Use commit() after */
+    uint8_t *write_space(size_t &length)
+    {
+        const auto offset = m_tail & (N - 1);
+        length = space() < N - offset ? space() : N - offset;
+        return m_data + offset;
+    }
+
+    void commit(size_t length) { m_tail += length; }
+
+    /* Copies as much of data as fits, returns the number of bytes written */
+    size_t write(const void *data, size_t length)
+    {
+        size_t written = 0;
+        while (written < length && space()) {
+            size_t chunk;
+            auto *dest = write_space(chunk);
+            if (chunk > length - written)
+                chunk = length - written;
+            memcpy(dest, static_cast<const uint8_t *>(data) + written, chunk);
+            commit(chunk);
+            written += chunk;
+        }
+        return written;
+    }
+
+    /* Copies the first length bytes without consuming them */
+    bool peek(void *dest, size_t length) const
+    {
+        if (length > size())
+            return false;
+        const auto offset = m_head & (N - 1);
+        const auto first = length < N - offset ? length : N - offset;
+        memcpy(dest, m_data + offset, first);
+        memcpy(static_cast<uint8_t *>(dest) + first, m_data, length - first);
+        return true;
+    }
+
+    /* The first length bytes if they don't wrap around, nullptr otherwise */
+    const uint8_t *contiguous(size_t length) const
+    {
+        const auto offset = m_head & (N - 1);
+        return length <= size() && offset + length <= N ? m_data + offset : nullptr;
+    }
+
+    void consume(size_t length) { m_head += length < size() ? length : size(); }
+};
@@ -32,6 +32,9 @@
 #define S_CONTROL                       "control"
 #define S_REGEX                         "regex"
 #define S_FILTER_MODE                   "filter_mode"
+#define S_RECORD_INPUT                  "record_input"
+#define S_ATLAS_CACHE                   "atlas_cache"
+#define S_ATLAS_CACHE_SIZE              "atlas_cache_size"
 
 /* Misc values */
 #define S_INPUT_SOURCE                  "io.input_source"
@@ -49,6 +52,10 @@
 #define S_MONITOR_H_CENTER              "io.monitor_h_center"
 #define S_MONITOR_V_CENTER              "io.monitor_v_center"
 #define S_RELOAD_PAD_DEVICES            "io.reload_pads"
+#define S_MIN_VISIBLE                   "io.min_visible"
+#define S_INPUT_MODE                    "io.input_mode"
+#define S_REPLAY_FILE                   "io.replay_file"
+#define S_REPLAY_LOOP                   "io.replay_loop"
 
 /* History source */
 #define S_HISTORY_SIZE                  "io.history_size"
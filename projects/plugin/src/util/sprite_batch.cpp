@@ -0,0 +1,126 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "sprite_batch.hpp"
+#include <obs-module.h>
+#include <math.h>
+#include <string.h>
+
+sprite_batch::~sprite_batch()
+{
+    if (m_vertex_buffer) {
+        obs_enter_graphics();
+        gs_vertexbuffer_destroy(m_vertex_buffer);
+        obs_leave_graphics();
+    }
+}
+
+void sprite_batch::begin(gs_texture_t *texture)
+{
+    m_texture = texture;
+    m_points.clear();
+    m_uvs.clear();
+
+    if (texture) {
+        m_tex_cx = float(gs_texture_get_width(texture));
+        m_tex_cy = float(gs_texture_get_height(texture));
+    }
+}
+
+void sprite_batch::add(const gs_rect *rect, const vec2 *pos)
+{
+    const vec2 corners[4] = {{pos->x, pos->y},
+                             {pos->x + rect->cx, pos->y},
+                             {pos->x, pos->y + rect->cy},
+                             {pos->x + rect->cx, pos->y + rect->cy}};
+    add_quad(corners, rect);
+}
+
+void sprite_batch::add(const gs_rect *rect, const vec2 *pos, const float angle)
+{
+    const auto half_cx = rect->cx / 2.f, half_cy = rect->cy / 2.f;
+    const auto s = sinf(angle), c = cosf(angle);
+    const vec2 offset = {pos->x - half_cx, pos->y + half_cy};
+    const vec2 local[4] = {{-half_cx, -half_cy}, {half_cx, -half_cy}, {-half_cx, half_cy}, {half_cx, half_cy}};
+    vec2 corners[4];
+
+    for (int i = 0; i < 4; i++) {
+        corners[i].x = local[i].x * c - local[i].y * s + offset.x;
+        corners[i].y = local[i].x * s + local[i].y * c + offset.y;
+    }
+    add_quad(corners, rect);
+}
+
+void sprite_batch::add_quad(const vec2 corners[4], const gs_rect *rect)
+{
+    const auto u0 = rect->x / m_tex_cx, v0 = rect->y / m_tex_cy;
+    const auto u1 = (rect->x + rect->cx) / m_tex_cx, v1 = (rect->y + rect->cy) / m_tex_cy;
+    const vec2 uvs[4] = {{u0, v0}, {u1, v0}, {u0, v1}, {u1, v1}};
+
+    /* Two triangles, same winding as gs_draw_sprite */
+    static const int order[SPRITE_BATCH_VERTS] = {0, 1, 2, 2, 1, 3};
+    for (const auto i : order) {
+        vec3 point;
+        vec3_set(&point, corners[i].x, corners[i].y, 0.f);
+        m_points.emplace_back(point);
+        m_uvs.emplace_back(uvs[i]);
+    }
+}
+
+bool sprite_batch::reserve_buffer(const size_t quads)
+{
+    if (m_vertex_buffer && quads <= m_capacity)
+        return true;
+
+    auto capacity = m_capacity ? m_capacity : SPRITE_BATCH_MIN_QUADS;
+    while (capacity < quads)
+        capacity *= 2;
+
+    if (m_vertex_buffer)
+        gs_vertexbuffer_destroy(m_vertex_buffer);
+
+    /* The vertex buffer takes ownership of this */
+    auto *data = gs_vbdata_create();
+    data->num = capacity * SPRITE_BATCH_VERTS;
+    data->points = static_cast<vec3 *>(bzalloc(sizeof(vec3) * data->num));
+    data->num_tex = 1;
+    data->tvarray = static_cast<gs_tvertarray *>(bzalloc(sizeof(gs_tvertarray)));
+    data->tvarray[0].width = 2;
+    data->tvarray[0].array = bzalloc(sizeof(vec2) * data->num);
+
+    m_vertex_buffer = gs_vertexbuffer_create(data, GS_DYNAMIC);
+    m_capacity = m_vertex_buffer ? capacity : 0;
+    return m_vertex_buffer != nullptr;
+}
+
+void sprite_batch::draw(gs_effect_t *effect)
+{
+    if (!m_texture || m_points.empty() || !reserve_buffer(size()))
+        return;
+
+    /* Only the used part is drawn, the rest of the buffer keeps stale sprites */
+    auto *data = gs_vertexbuffer_get_data(m_vertex_buffer);
+    memcpy(data->points, m_points.data(), sizeof(vec3) * m_points.size());
+    memcpy(data->tvarray[0].array, m_uvs.data(), sizeof(vec2) * m_uvs.size());
+    gs_vertexbuffer_flush(m_vertex_buffer);
+
+    gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), m_texture);
+    gs_load_vertexbuffer(m_vertex_buffer);
+    gs_load_indexbuffer(nullptr);
+    gs_draw(GS_TRIS, 0, uint32_t(m_points.size()));
+}
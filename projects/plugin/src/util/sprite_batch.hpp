@@ -0,0 +1,68 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <graphics/graphics.h>
+#include <graphics/vec2.h>
+#include <graphics/vec3.h>
+#include <vector>
+
+/* Six vertices per quad, since sprites are drawn as a triangle list */
+#define SPRITE_BATCH_VERTS 6
+#define SPRITE_BATCH_MIN_QUADS 64
+
+/* Collects all sprites of one overlay (which all come from the same texture)
+ * and draws them with a single draw call from one dynamic vertex buffer.
+ * The buffer only grows, so after the first few frames no memory is allocated.
+ * Graphics thread only */
+class sprite_batch {
+public:
+    sprite_batch() = default;
+    ~sprite_batch();
+
+    sprite_batch(const sprite_batch &) = delete;
+    sprite_batch &operator=(const sprite_batch &) = delete;
+
+    /* Starts a new frame, all sprites are cut out from texture */
+    void begin(gs_texture_t *texture);
+
+    /* Same as gs_draw_sprite_subregion at pos */
+    void add(const gs_rect *rect, const vec2 *pos);
+
+    /* Rotated by angle (radians) around the center, then moved to (pos.x - cx / 2, pos.y + cy / 2).
+     * Odd, but that's where the mouse arrow has always been drawn */
+    void add(const gs_rect *rect, const vec2 *pos, float angle);
+
+    /* Uploads and draws all sprites added since begin() */
+    void draw(gs_effect_t *effect);
+
+    size_t size() const { return m_points.size() / SPRITE_BATCH_VERTS; }
+
+private:
+    /* Corners in the order top left, top right, bottom left, bottom right */
+    void add_quad(const vec2 corners[4], const gs_rect *rect);
+    bool reserve_buffer(size_t quads);
+
+    gs_texture_t *m_texture = nullptr;
+    float m_tex_cx = 1.f, m_tex_cy = 1.f;
+    gs_vertbuffer_t *m_vertex_buffer = nullptr;
+    size_t m_capacity = 0; /* In quads */
+    std::vector<vec3> m_points;
+    std::vector<vec2> m_uvs;
+};
@@ -0,0 +1,66 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Bounded lock-free single producer/single consumer queue.
+ * Storage is fixed at compile time, so neither side ever allocates and
+ * the producer never blocks: if the queue is full the item is dropped
+ * and counted instead */
+template<class T, size_t N> class spsc_queue {
+    static_assert(N && (N & (N - 1)) == 0, "spsc_queue size must be a power of two");
+
+    T m_items[N]{};
+    std::atomic<size_t> m_head{0}; /* Next item to pop, written by the consumer */
+    char m_pad0[64 - sizeof(std::atomic<size_t>)]{};
+    std::atomic<size_t> m_tail{0}; /* Next free slot, written by the producer */
+    char m_pad1[64 - sizeof(std::atomic<size_t>)]{};
+    std::atomic<uint32_t> m_dropped{0};
+
+public:
+    /* Producer side, returns false if the queue was full */
+    bool push(const T &item)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= N) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[tail & (N - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Consumer side, returns false if the queue was empty */
+    bool pop(T &item)
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+        item = m_items[head & (N - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Number of items dropped because the queue was full */
+    uint32_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,197 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "texture_cache.hpp"
+#include "atlas_disk_cache.hpp"
+#include "log.h"
+#include "obs_util.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <obs-module.h>
+#include <util/bmem.h>
+#include <vector>
+extern "C" {
+#include <graphics/image-file.h>
+}
+
+namespace texture_cache {
+struct entry {
+    std::string path; /* Canonical path */
+    int64_t mtime;
+    std::weak_ptr<gs_image_file_t> image;
+};
+
+static std::mutex mutex;
+static std::vector<entry> entries;
+static std::vector<std::string> loading; /* Canonical paths which are being decoded */
+static std::condition_variable loaded;
+static std::vector<std::weak_ptr<gs_image_file_t>> uploads; /* Decoded, but without a texture yet */
+/* Atomic, since the last overlay releasing an atlas can do so outside of the lock */
+static std::atomic<size_t> atlas_count{0};
+static std::atomic<uint64_t> atlas_bytes{0};
+static size_t load_count = 0, hit_count = 0, disk_hit_count = 0;
+
+static uint64_t image_size(const gs_image_file_t *image)
+{
+    return uint64_t(image->cx) * image->cy * 4;
+}
+
+static double to_mib(uint64_t bytes)
+{
+    return double(bytes) / (1024 * 1024);
+}
+
+static void release(gs_image_file_t *image)
+{
+    if (image->loaded) {
+        atlas_count--;
+        atlas_bytes -= image_size(image);
+    }
+    obs_enter_graphics();
+    gs_image_file_free(image);
+    obs_leave_graphics();
+    delete image;
+}
+
+void upload(gs_image_file_t *image)
+{
+    /* Every user of a shared image calls this, but only the first one has anything to do.
+     * Callers hold the graphics context, so they can't run into each other */
+    if (image->loaded && !image->texture)
+        gs_image_file_init_texture(image);
+}
+
+std::shared_ptr<gs_image_file_t> acquire(const std::string &path, const bool upload_texture)
+{
+    std::string key;
+    int64_t mtime;
+    util_file_version(path, key, mtime);
+
+    std::shared_ptr<gs_image_file_t> image;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        /* Drop atlases no overlay uses anymore */
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](const entry &e) { return e.image.expired(); }),
+                      entries.end());
+
+        for (const auto &e : entries) {
+            if (e.path == key && e.mtime == mtime && (image = e.image.lock()))
+                break;
+        }
+
+        /* Images are decoded outside of the lock, so loaders can decode different
+         * files at the same time. A file which is already being decoded is waited on */
+        if (image || std::find(loading.begin(), loading.end(), key) == loading.end())
+            break;
+        loaded.wait(lock);
+    }
+
+    if (image) {
+        hit_count++;
+        lock.unlock();
+        if (upload_texture) {
+            obs_enter_graphics();
+            upload(image.get());
+            obs_leave_graphics();
+        }
+        return image;
+    }
+
+    loading.emplace_back(key);
+    lock.unlock();
+
+    image.reset(new gs_image_file_t(), release);
+    uint64_t hash;
+    const auto from_disk = atlas_disk_cache::load(path, hash, image.get());
+    if (!from_disk) {
+        gs_image_file_init(image.get(), path.c_str());
+        atlas_disk_cache::store(hash, image.get());
+    }
+
+    if (upload_texture) {
+        obs_enter_graphics();
+        upload(image.get());
+        obs_leave_graphics();
+    }
+
+    lock.lock();
+    loading.erase(std::find(loading.begin(), loading.end(), key));
+    loaded.notify_all();
+    if (!image->loaded)
+        return nullptr;
+
+    load_count++;
+    if (from_disk)
+        disk_hit_count++;
+    atlas_count++;
+    atlas_bytes += image_size(image.get());
+    entries.emplace_back(entry{key, mtime, image});
+    if (!upload_texture)
+        uploads.emplace_back(image);
+    binfo("Loaded atlas %s (%ux%u, %.2f MiB), %zu atlas(es) in use with %.2f MiB", path.c_str(), image->cx,
+          image->cy, to_mib(image_size(image.get())), atlas_count.load(), to_mib(atlas_bytes));
+    return image;
+}
+
+std::shared_ptr<gs_image_file_t> create(const uint32_t cx, const uint32_t cy, const uint8_t *pixels)
+{
+    std::shared_ptr<gs_image_file_t> image(new gs_image_file_t(), release);
+    image->cx = cx;
+    image->cy = cy;
+    image->format = GS_RGBA;
+    image->texture_data = static_cast<uint8_t *>(bmemdup(pixels, image_size(image.get())));
+    image->loaded = true;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    load_count++;
+    atlas_count++;
+    atlas_bytes += image_size(image.get());
+    uploads.emplace_back(image);
+    return image;
+}
+
+void upload_pending()
+{
+    std::vector<std::weak_ptr<gs_image_file_t>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.swap(uploads);
+    }
+
+    for (const auto &weak : pending) {
+        const auto image = weak.lock();
+        if (image)
+            upload(image.get());
+    }
+}
+
+texture_cache_stats stats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    texture_cache_stats result;
+    result.atlases = atlas_count;
+    result.bytes = atlas_bytes;
+    result.loads = load_count;
+    result.hits = hit_count;
+    result.disk_hits = disk_hit_count;
+    return result;
+}
+}
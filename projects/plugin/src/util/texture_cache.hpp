@@ -0,0 +1,63 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+typedef struct gs_image_file gs_image_file_t;
+
+struct texture_cache_stats {
+    size_t atlases = 0;   /* Loaded image files */
+    size_t loads = 0;     /* Times an image was loaded */
+    size_t hits = 0;      /* Times an already loaded image was reused */
+    size_t disk_hits = 0; /* Loads which were read from the disk cache instead of decoded */
+    uint64_t bytes = 0;   /* Estimated VRAM use of all loaded atlases (RGBA) */
+};
+
+namespace texture_cache {
+/* Returns the atlas for this image file, shared by all overlays using the
+ * same file. Files are identified by their canonical path and modification
+ * time, so a changed image is loaded again while overlays still using the old
+ * one keep it until they release it. Images are freed once no overlay holds
+ * on to them anymore. Returns nullptr if the image couldn't be loaded.
+ * Without upload the image is only decoded and has no texture until
+ * upload() is called, which allows decoding outside of the graphics thread.
+ * Different files are decoded in parallel, a file wanted by several threads
+ * at once is only decoded once */
+std::shared_ptr<gs_image_file_t> acquire(const std::string &path, bool upload = true);
+
+/* Wraps already decoded RGBA pixels (e.g. the atlas embedded in a *.iolayout
+ * file) as an image. The pixels are copied, the texture is created on upload().
+ * Counted in stats(), but not shared, the caller does that */
+std::shared_ptr<gs_image_file_t> create(uint32_t cx, uint32_t cy, const uint8_t *pixels);
+
+/* Creates the texture of a decoded image, if it doesn't have one yet.
+ * Must be called inside the graphics context */
+void upload(gs_image_file_t *image);
+
+/* Creates the textures of all images decoded without upload so far, so
+ * overlays which finished loading at the same time share one trip to the
+ * graphics thread. Must be called inside the graphics context */
+void upload_pending();
+
+texture_cache_stats stats();
+}
@@ -0,0 +1,64 @@
+/*************************************************************************
+ * This file is part of input-overlay
+ * github.con/univrsal/input-overlay
+ * Copyright 2020 univrsal <uni@vrsal.cf>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/* Lock-free single writer/single reader publication of a value.
+ * The writer copies its state into the back buffer and swaps it with the
+ * shared middle buffer, the reader swaps the middle buffer with its front
+ * buffer if a newer value was published. Neither side ever waits for the other,
+ * so the writer (e.g. the uiohook thread) is unaffected by how often or
+ * how long the reader (the obs video thread) looks at the data.
+ * Readers must all run on the same thread and must not hold on to the
+ * returned reference across calls to read().
+ */
+template<class T> class triple_buffer {
+    static const uint8_t fresh_bit = 0x4;
+    static const uint8_t index_mask = 0x3;
+
+    /* Writer and reader indices are padded apart to keep the two threads
+     * from bouncing the same cache line (without needing over-aligned allocations) */
+    T m_buffers[3]{};
+    std::atomic<uint8_t> m_middle{1}; /* Index of the shared buffer + fresh_bit if unread */
+    char m_pad0[63]{};
+    uint8_t m_back = 0; /* Only touched by the writer */
+    char m_pad1[63]{};
+    uint8_t m_front = 2; /* Only touched by the reader */
+
+public:
+    /* Writer side, publishes a copy of value */
+    void publish(const T &value)
+    {
+        m_buffers[m_back] = value;
+        m_back = m_middle.exchange(m_back | fresh_bit, std::memory_order_acq_rel) & index_mask;
+    }
+
+    /* Reader side, returns the latest published value */
+    const T &read()
+    {
+        if (m_middle.load(std::memory_order_relaxed) & fresh_bit)
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & index_mask;
+        return m_buffers[m_front];
+    }
+
+    /* True if the writer published something since the last read() */
+    bool fresh() const { return m_middle.load(std::memory_order_relaxed) & fresh_bit; }
+};